@@ -0,0 +1,42 @@
+/**
+ * @file 13_Multi_Output.ino
+ * @brief Пример работы с несколькими выходами (RMT-каналами) из одного объекта.
+ * 
+ * Длинная инсталляция разбита на 4 ленты по 1000 светодиодов, каждая на своем пине.
+ * Все ленты передаются ОДНОВРЕМЕННО, поэтому время кадра определяется самой
+ * длинной лентой (~30 мс на 1000 LED), а не общим количеством (~120 мс на 4000 LED).
+ * 
+ * АРХИТЕКТУРА:
+ * - beginMulti() делит один логический буфер на сегменты.
+ * - Индексация пикселей сквозная: пиксели 0..999 - первый пин, 1000..1999 - второй и т.д.
+ * - Все функции (setPixel, fill, эффекты) работают как с одной длинной лентой.
+ */
+#include <SavaLED_ESP32.h>
+
+// --- Конфигурация ---
+const int      PINS[]   = { 14, 15, 16, 17 };
+const uint16_t COUNTS[] = { 1000, 1000, 1000, 1000 };
+#define NUM_OUTPUTS 4
+#define BRIGHTNESS  80
+
+SavaLED_ESP32 strip;
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("\nПример 13: Несколько выходов");
+
+  if (!strip.beginMulti(NUM_OUTPUTS, PINS, COUNTS)) {
+    Serial.println("Ошибка инициализации!");
+    while (true);
+  }
+  strip.setBrightness(BRIGHTNESS);
+  Serial.printf("Всего светодиодов: %d\n", strip.getNumLeds());
+}
+
+void loop() {
+  if (strip.canShow()) {
+    // Радуга проходит через все 4 ленты без разрывов на границах сегментов
+    strip.rainbowCycle(200);
+    strip.show();
+  }
+}
@@ -0,0 +1,48 @@
+/**
+ * @file 14_Render_Task.ino
+ * @brief Пример анимации в отдельной задаче FreeRTOS на другом ядре.
+ * 
+ * Функция отрисовки регистрируется через addRenderCallback(), а startRenderTask()
+ * запускает задачу, которая 60 раз в секунду вызывает ее и show().
+ * loop() при этом полностью свободен: задержки в нем (работа с сетью, delay())
+ * никак не влияют на плавность анимации.
+ * 
+ * АРХИТЕКТУРА:
+ * - Пока задача рендера работает, рисование идет ТОЛЬКО из функций отрисовки.
+ * - getMissedFrames() показывает, сколько кадров не уложились в свой период.
+ */
+#include <SavaLED_ESP32.h>
+
+// --- Конфигурация ---
+#define LED_PIN    14
+#define NUM_LEDS   100
+#define BRIGHTNESS 150
+#define TARGET_FPS 60
+
+SavaLED_ESP32 strip;
+
+// Функция отрисовки: вызывается задачей рендера перед каждым show()
+void drawFrame(SavaLED_ESP32& s, void* arg) {
+  s.rainbowCycle(150);
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("\nПример 14: Задача рендера");
+
+  if (!strip.begin(NUM_LEDS, LED_PIN)) {
+    Serial.println("Ошибка инициализации!");
+    while (true);
+  }
+  strip.setBrightness(BRIGHTNESS);
+
+  strip.addRenderCallback(drawFrame);
+  // Ядро 0, приоритет 5: loop() продолжает работать на ядре 1
+  strip.startRenderTask(TARGET_FPS, 0, 5);
+}
+
+void loop() {
+  // Имитация "тяжелого" кода приложения - анимация от этого не дергается
+  delay(1000);
+  Serial.printf("Пропущено кадров: %u\n", strip.getMissedFrames());
+}
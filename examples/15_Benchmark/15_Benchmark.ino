@@ -0,0 +1,102 @@
+/**
+ * @file 15_Benchmark.ino
+ * @brief Замер производительности функций библиотеки на разной длине ленты.
+ * 
+ * Скетч по очереди инициализирует ленту на 60, 300, 1000, 3000 и 10000 светодиодов
+ * и измеряет среднее время вызова основных функций:
+ *   show() (подготовка кадра), fill(), setPixelHSV() (вся лента),
+ *   rainbowCycle(), rainbowStatic(), runCometsEffect().
+ * Для show() дополнительно выводится время передачи по RMT из getStats().
+ * Эффекты замеряются покадрово: после каждого вызова - show() вне замера, иначе
+ * rainbowCycle() исчерпает слоты состояния кадра, а кометы не сделают ни шага.
+ * Тот же замер без платы - test/host (make bench).
+ * 
+ * Результат печатается в Serial в виде CSV, его удобно сравнивать до и после
+ * изменений в библиотеке. Лента может быть не подключена - RMT передает данные
+ * независимо от нагрузки на пине.
+ * 
+ * ВАЖНО: 10000 светодиодов требуют ~60 КБ RAM (буфер рисования + буфер отправки).
+ */
+#include <SavaLED_ESP32.h>
+
+// --- Конфигурация ---
+#define LED_PIN     14
+#define ITERATIONS  20
+
+const uint16_t SIZES[] = { 60, 300, 1000, 3000, 10000 };
+const uint32_t palette[] = { RED, GOLD, CYAN, BLUE };
+
+SavaLED_ESP32 strip;
+
+// Среднее время одного вызова fn() в микросекундах
+template <typename F>
+uint32_t measure(F fn) {
+  uint32_t start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    fn();
+  }
+  return (micros() - start) / ITERATIONS;
+}
+
+// То же для эффектов: каждый вызов - отдельный кадр 60 FPS (кометы ограничены этой
+// частотой), show() не входит в замер
+template <typename F>
+uint32_t measureFrames(F fn) {
+  uint32_t total = 0;
+  uint32_t next = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    while ((int32_t)(micros() - next) < 0);
+    next += 1000000 / 60;
+    strip.waitForFrame();
+    uint32_t start = micros();
+    fn();
+    total += micros() - start;
+    strip.show();
+  }
+  return total / ITERATIONS;
+}
+
+void benchmarkSize(uint16_t num_leds) {
+  if (!strip.begin(num_leds, LED_PIN)) {
+    Serial.printf("%u,ошибка инициализации\n", num_leds);
+    return;
+  }
+  strip.setBrightness(128); // Яркость < 255 включает полный проход яркость+гамма в show()
+
+  uint32_t t_fill = measure([]() { strip.fill(ORANGE); });
+  uint32_t t_hsv = measure([&]() {
+    for (uint16_t i = 0; i < num_leds; i++) strip.setPixelHSV(i, i, 255, 255);
+  });
+  uint32_t t_cycle = measureFrames([]() { strip.rainbowCycle(255); });
+  uint32_t t_static = measure([&]() { strip.rainbowStatic(0, num_leds); });
+  uint32_t t_comets = measureFrames([]() { strip.runCometsEffect(5, 15, palette, 4, BLACK, 10); });
+
+  // show(): ждем окончания предыдущей передачи, чтобы кадры не отбрасывались
+  strip.resetStats();
+  uint32_t t_show = measure([]() {
+    strip.waitForFrame();
+    strip.show();
+  });
+  strip.waitForFrame();
+  SavaLEDStats st = strip.getStats();
+
+  Serial.printf("%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+                num_leds, st.prep.avg_us, st.wire.avg_us, t_fill, t_hsv,
+                t_cycle, t_static, t_comets, t_show);
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("\nПример 15: Бенчмарк");
+  Serial.printf("CPU: %u МГц, итераций на замер: %d\n", getCpuFrequencyMhz(), ITERATIONS);
+  Serial.println("leds,show_prep_us,show_wire_us,fill_us,setPixelHSV_us,rainbowCycle_us,rainbowStatic_us,comets_us,show_total_us");
+
+  for (uint16_t size : SIZES) {
+    benchmarkSize(size);
+  }
+  Serial.println("Готово.");
+}
+
+void loop() {
+}
@@ -0,0 +1,48 @@
+/**
+ * @file 16_Effect_Engine.ino
+ * @brief Пример эффектов-объектов и планировщика runEffects().
+ * 
+ * Лента делится на три отрезка, на каждом работает свой эффект со своей скоростью.
+ * Состояние каждого эффекта хранится в его объекте, поэтому два одинаковых эффекта
+ * на разных отрезках не мешают друг другу.
+ * 
+ * АРХИТЕКТУРА:
+ * - Объекты эффектов - глобальные переменные (без выделения памяти в куче).
+ * - runEffects() перерисовывает только эффекты, у которых был шаг анимации.
+ */
+#include <SavaLED_ESP32.h>
+
+// --- Конфигурация ---
+#define LED_PIN    14
+#define NUM_LEDS   120
+#define BRIGHTNESS 150
+
+SavaLED_ESP32 strip;
+
+const uint32_t palette[] = { GOLD, CYAN, MAGENTA };
+
+SavaRainbowCycleEffect rainbowFast(220);
+SavaRainbowCycleEffect rainbowSlow(40, 120);
+SavaCometsEffect comets(4, 10, palette, 3, strip.Color(0, 0, 20), 700);
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("\nПример 16: Эффекты-объекты");
+
+  if (!strip.begin(NUM_LEDS, LED_PIN)) {
+    Serial.println("Ошибка инициализации!");
+    while (true);
+  }
+  strip.setBrightness(BRIGHTNESS);
+
+  strip.addEffect(rainbowFast, 0, 40);
+  strip.addEffect(rainbowSlow, 40, 40, true);
+  strip.addEffect(comets, 80, 40);
+}
+
+void loop() {
+  if (strip.canShow()) {
+    strip.runEffects();
+    strip.show();
+  }
+}
@@ -0,0 +1,67 @@
+/**
+ * @file 17_Particles.ino
+ * @brief Пример системы частиц SavaParticles: "фейерверк" на ленте.
+ * 
+ * Время от времени в случайной точке ленты происходит вспышка: из нее в обе стороны
+ * разлетаются искры с разной скоростью и временем жизни, затухая к концу жизни.
+ * 
+ * АРХИТЕКТУРА:
+ * - Пул частиц выделяется один раз в setup(), дальше куча не используется.
+ * - Позиция и скорость (пикселей в секунду) - в 8.8 (SAVA_PX = 1 пиксель), медленные искры
+ *   движутся плавно. Движение идет по времени кадра и не зависит от FPS.
+ * - Частицы - обычный эффект, шаги и отрисовку делает runEffects().
+ */
+#include <SavaLED_ESP32.h>
+
+// --- Конфигурация ---
+#define LED_PIN       14
+#define NUM_LEDS      300
+#define BRIGHTNESS    150
+#define MAX_SPARKS    400
+#define SPARKS_PER_BURST 40
+
+SavaLED_ESP32 strip;
+SavaParticles sparks;
+
+const uint32_t palette[] = { GOLD, ORANGE, CYAN, MAGENTA, WHITE };
+unsigned long lastBurst = 0;
+
+void burst() {
+  int32_t center = random(NUM_LEDS) * SAVA_PX;
+  uint32_t color = palette[random(5)];
+  for (int i = 0; i < SPARKS_PER_BURST; i++) {
+    int32_t vel = random(5, 52) * SAVA_PX * (random(2) ? 1 : -1); // 5..51 пикселей в секунду
+    if (sparks.spawn(center, vel, color, random(600, 1800)) < 0) break; // Пул заполнен
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("\nПример 17: Частицы");
+
+  if (!strip.begin(NUM_LEDS, LED_PIN)) {
+    Serial.println("Ошибка инициализации!");
+    while (true);
+  }
+  strip.setBrightness(BRIGHTNESS);
+
+  if (!sparks.begin(MAX_SPARKS)) {
+    Serial.println("Не хватило памяти под частицы!");
+    while (true);
+  }
+  sparks.setTail(4);
+  sparks.interval_ms = 15;
+  strip.addEffect(sparks, 0, NUM_LEDS);
+}
+
+void loop() {
+  if (millis() - lastBurst > 400) {
+    lastBurst = millis();
+    burst();
+  }
+
+  if (strip.canShow()) {
+    strip.runEffects();
+    strip.show();
+  }
+}
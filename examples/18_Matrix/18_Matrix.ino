@@ -0,0 +1,67 @@
+/**
+ * @file 18_Matrix.ino
+ * @brief Пример матрицы SavaMatrix: бегущая строка из полос и рамка.
+ * 
+ * Матрица 16x16 собрана из четырех панелей 8x8 (2x2), внутри панели - змейка по строкам.
+ * Рисование идет по координатам (x, y), раскладку в номера светодиодов пересчитывает
+ * таблица, построенная один раз в setup().
+ * 
+ * АРХИТЕКТУРА:
+ * - Статичная рамка рисуется в нижнем слое один раз.
+ * - Полосы в верхнем слое сдвигаются scroll() на пиксель за кадр, новая колонка дорисовывается справа.
+ */
+#include <SavaLED_Matrix.h>
+
+// --- Конфигурация ---
+#define LED_PIN    14
+#define BRIGHTNESS 60
+
+SavaLED_ESP32 strip;
+SavaMatrix matrix(strip);
+
+int8_t frameLayer, stripesLayer;
+uint8_t hue = 0;
+unsigned long lastStep = 0;
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("\nПример 18: Матрица");
+
+  if (!strip.begin(16 * 16, LED_PIN)) {
+    Serial.println("Ошибка инициализации!");
+    while (true);
+  }
+  strip.setBrightness(BRIGHTNESS);
+
+  SavaMatrixLayout layout;
+  layout.panel_width = 8;
+  layout.panel_height = 8;
+  layout.tiles_x = 2;
+  layout.tiles_y = 2;
+  if (!matrix.begin(layout)) {
+    Serial.println("Не хватило памяти под таблицу матрицы!");
+    while (true);
+  }
+
+  frameLayer = strip.addLayer();
+  stripesLayer = strip.addLayer(SAVA_BLEND_KEYED);
+
+  strip.drawToLayer(frameLayer);
+  matrix.drawRect(0, 0, matrix.width(), matrix.height(), strip.Color(40, 40, 40));
+  matrix.drawLine(0, 0, matrix.width() - 1, matrix.height() - 1, strip.Color(0, 0, 40));
+}
+
+void loop() {
+  if (millis() - lastStep < 40 || !strip.canShow()) return;
+  lastStep = millis();
+
+  strip.drawToLayer(stripesLayer);
+  matrix.scroll(-1, 0);
+  // Новая колонка справа: наклонная полоса меняющегося цвета
+  uint8_t x = matrix.width() - 1;
+  matrix.setPixel(x, hue % matrix.height(), strip.ColorHSV(hue * 4));
+  matrix.setPixel(x, (hue + 8) % matrix.height(), strip.ColorHSV(hue * 4 + 128));
+  hue++;
+
+  strip.show();
+}
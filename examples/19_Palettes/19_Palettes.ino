@@ -0,0 +1,66 @@
+/**
+ * @file 19_Palettes.ino
+ * @brief Пример палитр: бегущая палитра с плавной сменой каждые 10 секунд.
+ * 
+ * Эффект SavaPaletteCycleEffect рисует палитру current. Раз в 10 секунд выбирается
+ * следующая палитра из списка, и current плавно перетекает в нее через fadeToward().
+ * 
+ * АРХИТЕКТУРА:
+ * - Палитра хранит 16 опорных цветов, таблица на 256 цветов строится один раз.
+ * - fadeToward() за кадр сдвигает каждый канал таблицы не больше чем на шаг - переход без рывков.
+ */
+#include <SavaLED_ESP32.h>
+
+// --- Конфигурация ---
+#define LED_PIN    14
+#define NUM_LEDS   120
+#define BRIGHTNESS 150
+
+SavaLED_ESP32 strip;
+
+// Своя палитра: градиент по опорным точкам
+const SavaGradientStop sunsetStops[] = {
+  {0,   0x100020},
+  {80,  0x800040},
+  {160, 0xFF4000},
+  {255, 0xFFC040},
+};
+
+SavaPalette palettes[4] = {
+  SavaPalette(SAVA_PALETTE_RAINBOW),
+  SavaPalette(SAVA_PALETTE_OCEAN),
+  SavaPalette(SAVA_PALETTE_HEAT),
+  SavaPalette(SAVA_PALETTE_FOREST),
+};
+SavaPalette current(SAVA_PALETTE_RAINBOW);
+uint8_t targetIndex = 0;
+unsigned long lastSwitch = 0;
+
+SavaPaletteCycleEffect waves(current, 80);
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("\nПример 19: Палитры");
+
+  if (!strip.begin(NUM_LEDS, LED_PIN)) {
+    Serial.println("Ошибка инициализации!");
+    while (true);
+  }
+  strip.setBrightness(BRIGHTNESS);
+  palettes[3].setGradient(sunsetStops, 4); // Вместо FOREST - закат
+
+  strip.addEffect(waves, 0, NUM_LEDS);
+}
+
+void loop() {
+  if (millis() - lastSwitch > 10000) {
+    lastSwitch = millis();
+    targetIndex = (targetIndex + 1) % 4;
+  }
+
+  if (strip.canShow()) {
+    current.fadeToward(palettes[targetIndex], 2);
+    strip.runEffects();
+    strip.show();
+  }
+}
@@ -0,0 +1,75 @@
+/**
+ * @file 20_Network_Stream.ino
+ * @brief Пример приема кадров по сети: E1.31 (sACN), Art-Net и DDP.
+ *
+ * Лента из 340 светодиодов занимает две вселенные E1.31 (1 и 2, по 170 RGB-пикселей).
+ * В программе управления (xLights, Jinx!, Resolume, LedFx) укажите IP платы и протокол.
+ *
+ * АРХИТЕКТУРА:
+ * - Пакеты пишутся прямо в буфер ленты, show() вызывается приемником по концу кадра.
+ * - Пока кадров нет дольше 5 секунд, лента гаснет.
+ * - Раз в секунду в Serial выводятся счетчики приема.
+ */
+#include <WiFi.h>
+#include <SavaLED_Stream.h>
+
+// --- Конфигурация ---
+#define LED_PIN    14
+#define NUM_LEDS   340
+#define BRIGHTNESS 128
+
+const char* WIFI_SSID = "your-ssid";
+const char* WIFI_PASS = "your-password";
+
+SavaLED_ESP32 strip;
+SavaStreamReceiver receiver(strip);
+
+unsigned long lastFrame = 0;
+unsigned long lastReport = 0;
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("\nПример 20: Прием по сети");
+
+  if (!strip.begin(NUM_LEDS, LED_PIN)) {
+    Serial.println("Ошибка инициализации!");
+    while (true);
+  }
+  strip.setBrightness(BRIGHTNESS);
+  strip.setGammaCorrection(false); // Программы управления обычно уже применяют свою гамму
+
+  WiFi.mode(WIFI_STA);
+  WiFi.setSleep(false);            // Без энергосбережения пакеты не задерживаются
+  WiFi.begin(WIFI_SSID, WIFI_PASS);
+  while (WiFi.status() != WL_CONNECTED) delay(100);
+  Serial.print("IP: ");
+  Serial.println(WiFi.localIP());
+
+  SavaStreamConfig config;         // E1.31 с вселенной 1, Art-Net и DDP
+  if (!receiver.begin(config)) {
+    Serial.println("Не удалось открыть UDP-порты!");
+    while (true);
+  }
+}
+
+void loop() {
+  receiver.poll();
+  unsigned long now = millis();
+
+  const SavaStreamStats& stats = receiver.getStats();
+  static uint32_t frames = 0;
+  if (stats.frames != frames) {
+    frames = stats.frames;
+    lastFrame = now;
+  } else if (lastFrame && now - lastFrame > 5000 && strip.canShow()) {
+    strip.clear();
+    strip.show();
+    lastFrame = 0;
+  }
+
+  if (now - lastReport >= 1000) {
+    lastReport = now;
+    Serial.printf("Пакеты: %u, кадры: %u, устаревшие: %u, битые: %u\n",
+                  stats.packets, stats.frames, stats.out_of_order, stats.invalid);
+  }
+}
@@ -0,0 +1,87 @@
+/**
+ * @file 21_Animation_Playback.ino
+ * @brief Пример записи и воспроизведения анимации из файла LittleFS.
+ *
+ * При первом запуске 600 кадров (10 секунд при 60 FPS) эффекта-объекта записываются
+ * в файл /scene.sava. Дальше файл проигрывается по кругу: эффект больше не считается,
+ * каждый кадр - только распаковка в буфер ленты.
+ *
+ * АРХИТЕКТУРА:
+ * - Запись: эффект рисует кадр через runEffects(), буфер добавляется в файл.
+ * - Воспроизведение: файл читается кусками по 256 байт, в конце - seek(0) и повтор.
+ */
+#include <LittleFS.h>
+#include <SavaLED_Animation.h>
+
+// --- Конфигурация ---
+#define LED_PIN    14
+#define NUM_LEDS   144
+#define BRIGHTNESS 80
+#define FPS        60
+#define NUM_FRAMES 600
+
+const char* SCENE_PATH = "/scene.sava";
+
+SavaLED_ESP32 strip;
+SavaAnimPlayer player(strip);
+File scene;
+
+// Запись сцены: кадр эффекта рисуется и добавляется в файл
+void recordScene() {
+  SavaRainbowCycleEffect rainbow(150);
+  strip.addEffect(rainbow, 0, NUM_LEDS);
+
+  File out = LittleFS.open(SCENE_PATH, "w");
+  SavaAnimRecorder recorder;
+  recorder.begin(out, strip, 1000000 / FPS);
+  uint32_t next = micros();
+  for (uint16_t i = 0; i < NUM_FRAMES; i++) {
+    // Кадры в темпе воспроизведения: эффект шагает по часам кадра из show()
+    while ((int32_t)(micros() - next) < 0);
+    next += 1000000 / FPS;
+    strip.waitForFrame();
+    strip.show();
+    strip.runEffects();
+    recorder.addFrame(strip);
+  }
+  recorder.end();
+  Serial.printf("Записано %u кадров, %u байт (без сжатия %u)\n",
+                recorder.frames(), recorder.bytesWritten(), NUM_FRAMES * NUM_LEDS * 3);
+  out.close();
+  strip.clearEffects();
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("\nПример 21: Записанная анимация");
+
+  if (!strip.begin(NUM_LEDS, LED_PIN)) {
+    Serial.println("Ошибка инициализации!");
+    while (true);
+  }
+  strip.setBrightness(BRIGHTNESS);
+
+  if (!LittleFS.begin(true)) {
+    Serial.println("Ошибка LittleFS!");
+    while (true);
+  }
+  if (!LittleFS.exists(SCENE_PATH)) recordScene();
+
+  scene = LittleFS.open(SCENE_PATH, "r");
+  if (!player.begin(scene)) {
+    Serial.println("Файл сцены не подходит к ленте!");
+    while (true);
+  }
+}
+
+void loop() {
+  if (player.finished()) {
+    scene.seek(0);
+    player.begin(scene);
+  }
+  // Кадр сцены распаковывается по часам кадра ленты, а их обновляет show()
+  if (strip.canShow()) {
+    player.update();
+    strip.show();
+  }
+}
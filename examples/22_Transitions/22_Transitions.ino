@@ -0,0 +1,63 @@
+/**
+ * @file 22_Transitions.ino
+ * @brief Пример плавных переходов между эффектами: transitionEffect().
+ * 
+ * Каждые 8 секунд эффект на ленте сменяется следующим из списка, по очереди
+ * всеми видами перехода: смешивание, вытеснение, рассыпание.
+ * 
+ * АРХИТЕКТУРА:
+ * - Эффект занимает одно место планировщика, переход меняет эффект на этом месте.
+ * - Во время перехода оба эффекта продолжают идти, буферы перехода выделяются один раз.
+ */
+#include <SavaLED_ESP32.h>
+
+// --- Конфигурация ---
+#define LED_PIN    14
+#define NUM_LEDS   120
+#define BRIGHTNESS 150
+#define SCENE_MS   8000
+
+SavaLED_ESP32 strip;
+
+const uint32_t palette[] = { GOLD, CYAN, MAGENTA };
+
+SavaRainbowCycleEffect rainbow(150);
+SavaCometsEffect comets(4, 10, palette, 3, strip.Color(0, 0, 20), 700);
+SavaPalette ocean(SAVA_PALETTE_OCEAN);
+SavaPaletteCycleEffect waves(ocean, 60);
+SavaSolidEffect warmWhite(strip.Color(255, 120, 40));
+
+SavaEffect* scenes[] = { &rainbow, &comets, &waves, &warmWhite };
+const SavaTransition transitions[] = { SAVA_TRANSITION_FADE, SAVA_TRANSITION_WIPE, SAVA_TRANSITION_DISSOLVE };
+
+int8_t slot;
+uint8_t scene = 0;
+unsigned long lastChange = 0;
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("\nПример 22: Переходы между эффектами");
+
+  if (!strip.begin(NUM_LEDS, LED_PIN)) {
+    Serial.println("Ошибка инициализации!");
+    while (true);
+  }
+  strip.setBrightness(BRIGHTNESS);
+  slot = strip.addEffect(*scenes[0], 0, NUM_LEDS);
+}
+
+void loop() {
+  if (millis() - lastChange >= SCENE_MS) {
+    lastChange = millis();
+    scene = (scene + 1) % (sizeof(scenes) / sizeof(scenes[0]));
+    SavaTransition type = transitions[scene % 3];
+    if (!strip.transitionEffect(slot, *scenes[scene], type, 1500)) {
+      Serial.println("Нет памяти под переход - смена без перехода");
+    }
+  }
+
+  if (strip.canShow()) {
+    strip.runEffects();
+    strip.show();
+  }
+}
@@ -0,0 +1,58 @@
+/**
+ * @file 23_Segments.ino
+ * @brief Пример сегментов вывода: своя яркость, гамма и баланс белого у частей ленты.
+ *
+ * Одна лента - три светильника: подсветка полки (приглушенная), потолок (теплый белый)
+ * и вывеска (линейная яркость без гаммы). Раз в 10 секунд полка плавно
+ * разгорается и гаснет - меняется только яркость сегмента, кадр не перерисовывается.
+ *
+ * АРХИТЕКТУРА:
+ * - Один эффект на всю ленту, настройки сегментов применяются в show() одним проходом.
+ * - Смена яркости сегмента пересчитывает только его таблицы (768 байт для RGB).
+ */
+#include <SavaLED_ESP32.h>
+
+// --- Конфигурация ---
+#define LED_PIN    14
+#define NUM_LEDS   150
+#define BRIGHTNESS 200
+
+SavaLED_ESP32 strip;
+SavaRainbowCycleEffect rainbow(120);
+
+int8_t shelf, ceiling, sign;
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("\nПример 23: Сегменты вывода");
+
+  if (!strip.begin(NUM_LEDS, LED_PIN)) {
+    Serial.println("Ошибка инициализации!");
+    while (true);
+  }
+  strip.setBrightness(BRIGHTNESS);
+
+  shelf   = strip.addSegment(0, 50, "shelf");
+  ceiling = strip.addSegment(50, 70, "ceiling");
+  sign    = strip.addSegment(120, 30, "sign");
+  if (shelf < 0 || ceiling < 0 || sign < 0) {
+    Serial.println("Не удалось создать сегменты!");
+    while (true);
+  }
+  strip.setSegmentWhiteBalance(ceiling, 255, 180, 110);
+  strip.setSegmentGamma(sign, false);
+
+  strip.addEffect(rainbow, 0, NUM_LEDS);
+}
+
+void loop() {
+  // Треугольная волна 0..255..0 с периодом 10 секунд
+  uint16_t t = (millis() / 20) % 500;
+  uint8_t level = t < 250 ? t : 499 - t;
+  strip.setSegmentBrightness(shelf, 5 + level);
+
+  if (strip.canShow()) {
+    strip.runEffects();
+    strip.show();
+  }
+}
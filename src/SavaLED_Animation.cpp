@@ -0,0 +1,264 @@
+#include "SavaLED_Animation.h"
+
+// Типы команд кадра (старшие 2 бита байта команды)
+enum : uint8_t { OP_SKIP = 0, OP_LITERAL = 1, OP_REPEAT = 2, OP_END = 3 };
+// Пикселей на одну команду (6 бит счетчика)
+static const uint8_t OP_MAX = 64;
+static const uint8_t FORMAT_VERSION = 1;
+
+// ========================================================================================
+// --- Запись ---
+// ========================================================================================
+
+SavaAnimRecorder::~SavaAnimRecorder() {
+    end();
+}
+
+void SavaAnimRecorder::_put(const uint8_t* data, size_t len) {
+    size_t written = _out->write(data, len);
+    _bytes += written;
+    if (written != len) _failed = true;
+}
+
+// Серия команд одного типа: длинные отрезки делятся на куски по OP_MAX пикселей
+void SavaAnimRecorder::_run(uint8_t type, const uint8_t* pixels, uint16_t count) {
+    while (count) {
+        uint8_t n = count > OP_MAX ? OP_MAX : count;
+        uint8_t op = (type << 6) | (n - 1);
+        _put(&op, 1);
+        if (type == OP_LITERAL) {
+            _put(pixels, (size_t)n * _bpp);
+            pixels += (size_t)n * _bpp;
+        } else if (type == OP_REPEAT) {
+            _put(pixels, _bpp);
+        }
+        count -= n;
+    }
+}
+
+bool SavaAnimRecorder::begin(Print& out, uint16_t num_leds, const SavaPixelFormat& format, uint32_t frame_us) {
+    end();
+    if (num_leds == 0 || (format.bpp != 3 && format.bpp != 4)) return false;
+    _prev = (uint8_t*)malloc((size_t)num_leds * format.bpp);
+    if (!_prev) return false;
+    _out = &out;
+    _num_leds = num_leds;
+    _bpp = format.bpp;
+    _frames = _bytes = 0;
+    _failed = false;
+
+    const uint8_t header[SAVA_ANIM_HEADER] = {
+        'S', 'A', 'V', 'A', FORMAT_VERSION, format.bpp,
+        format.r, format.g, format.b, format.w,
+        (uint8_t)num_leds, (uint8_t)(num_leds >> 8),
+        (uint8_t)frame_us, (uint8_t)(frame_us >> 8), (uint8_t)(frame_us >> 16), (uint8_t)(frame_us >> 24)
+    };
+    _put(header, sizeof(header));
+    return !_failed;
+}
+
+bool SavaAnimRecorder::begin(Print& out, const SavaLED_ESP32& strip, uint32_t frame_us) {
+    return begin(out, strip.getNumLeds(), strip._fmt, frame_us);
+}
+
+bool SavaAnimRecorder::addFrame(const SavaLED_ESP32& strip) {
+    if (strip.getNumLeds() != _num_leds || strip._bpp != _bpp) return false;
+    // Буфер читается напрямую: getPixels() пометил бы всю ленту измененной
+    return addFrame(strip._pixels);
+}
+
+bool SavaAnimRecorder::addFrame(const uint8_t* pixels) {
+    if (!_out || !pixels) return false;
+    const uint8_t bpp = _bpp;
+    const uint16_t n = _num_leds;
+    const bool key = _frames == 0; // Первый кадр - целиком, без SKIP
+    auto unchanged = [&](uint16_t i) { return !key && !memcmp(pixels + i * bpp, _prev + i * bpp, bpp); };
+    auto same = [&](uint16_t a, uint16_t b) { return !memcmp(pixels + a * bpp, pixels + b * bpp, bpp); };
+
+    uint16_t i = 0;
+    while (i < n) {
+        // Не изменились: хвост кадра без изменений закрывает END
+        uint16_t j = i;
+        while (j < n && unchanged(j)) j++;
+        if (j > i) {
+            if (j == n) break;
+            _run(OP_SKIP, nullptr, j - i);
+            i = j;
+            continue;
+        }
+        // Повтор одного цвета
+        j = i + 1;
+        while (j < n && same(j, i)) j++;
+        if (j - i >= 2) {
+            _run(OP_REPEAT, pixels + i * bpp, j - i);
+            i = j;
+            continue;
+        }
+        // Пиксели как есть - до неизменившегося пикселя или начала повтора
+        j = i + 1;
+        while (j < n && !unchanged(j) && !(j + 1 < n && same(j, j + 1))) j++;
+        _run(OP_LITERAL, pixels + i * bpp, j - i);
+        i = j;
+    }
+    const uint8_t end_op = OP_END << 6;
+    _put(&end_op, 1);
+
+    memcpy(_prev, pixels, (size_t)n * bpp);
+    _frames++;
+    return !_failed;
+}
+
+void SavaAnimRecorder::end() {
+    free(_prev);
+    _prev = nullptr;
+    _out = nullptr;
+}
+
+// ========================================================================================
+// --- Воспроизведение ---
+// ========================================================================================
+
+size_t SavaAnimPlayer::_read(uint8_t* dst, size_t len) {
+    if (_data) {
+        size_t n = _size - _pos < len ? _size - _pos : len;
+        memcpy(dst, _data + _pos, n);
+        _pos += n;
+        return n;
+    }
+    size_t done = 0;
+    while (done < len) {
+        if (_chunk_pos == _chunk_len) {
+            _chunk_len = _in ? _in->readBytes(_chunk, SAVA_ANIM_CHUNK) : 0;
+            _chunk_pos = 0;
+            if (_chunk_len == 0) break;
+        }
+        size_t n = _chunk_len - _chunk_pos;
+        if (n > len - done) n = len - done;
+        memcpy(dst + done, _chunk + _chunk_pos, n);
+        _chunk_pos += n;
+        done += n;
+    }
+    return done;
+}
+
+bool SavaAnimPlayer::_header(const uint8_t* h) {
+    if (memcmp(h, "SAVA", 4) || h[4] != FORMAT_VERSION) return false;
+    const uint8_t bpp = h[5];
+    const uint16_t num_leds = h[10] | ((uint16_t)h[11] << 8);
+    if (!_strip._pixels || bpp != _strip._bpp) return false;
+    if (num_leds == 0 || (uint32_t)_offset + num_leds > _strip.getNumLeds()) return false;
+
+    // Положения каналов в пикселе файла (R, G, B[, W]) - разные и внутри пикселя,
+    // иначе перестановка оставила бы байты пикселя незаполненными
+    uint8_t used = 0;
+    for (uint8_t k = 0; k < bpp; k++) {
+        if (h[6 + k] >= bpp || (used & (1 << h[6 + k]))) return false;
+        used |= 1 << h[6 + k];
+    }
+
+    // Байт j пикселя файла -> байт _order[j] пикселя ленты
+    const SavaPixelFormat& f = _strip._fmt;
+    for (uint8_t j = 0; j < 4; j++) _order[j] = j;
+    _order[h[6]] = f.r;
+    _order[h[7]] = f.g;
+    _order[h[8]] = f.b;
+    if (bpp == 4) _order[h[9]] = f.w;
+    _reorder = false;
+    for (uint8_t j = 0; j < bpp; j++) {
+        if (_order[j] != j) _reorder = true;
+    }
+
+    _num_leds = num_leds;
+    _frame_us = h[12] | ((uint32_t)h[13] << 8) | ((uint32_t)h[14] << 16) | ((uint32_t)h[15] << 24);
+    _frame = 0;
+    _finished = false;
+    return true;
+}
+
+bool SavaAnimPlayer::begin(Stream& in, uint16_t offset) {
+    _in = &in;
+    _data = nullptr;
+    _chunk_len = _chunk_pos = 0;
+    _offset = offset;
+    _finished = true;
+    uint8_t h[SAVA_ANIM_HEADER];
+    if (_read(h, sizeof(h)) != sizeof(h)) return false;
+    return _header(h);
+}
+
+bool SavaAnimPlayer::begin(const uint8_t* data, size_t len, uint16_t offset) {
+    _in = nullptr;
+    _data = data;
+    _size = data ? len : 0;
+    _pos = 0;
+    _offset = offset;
+    _finished = true;
+    if (_size < SAVA_ANIM_HEADER) return false;
+    _pos = SAVA_ANIM_HEADER;
+    return _header(data);
+}
+
+// Перестановка байтов пикселей на месте, если запись шла на ленте с другим порядком цветов
+void SavaAnimPlayer::_fixOrder(uint8_t* p, uint16_t count) const {
+    const uint8_t bpp = _strip._bpp;
+    uint8_t tmp[4];
+    for (uint16_t i = 0; i < count; i++, p += bpp) {
+        memcpy(tmp, p, bpp);
+        for (uint8_t j = 0; j < bpp; j++) p[_order[j]] = tmp[j];
+    }
+}
+
+bool SavaAnimPlayer::nextFrame() {
+    if (_finished || !_strip._pixels) return false;
+    uint8_t op;
+    if (_read(&op, 1) != 1) {
+        // Конец данных: из памяти можно начать сначала, первый кадр записан целиком
+        if (_loop && _data) _pos = SAVA_ANIM_HEADER;
+        if (_read(&op, 1) != 1) {
+            _finished = true;
+            return false;
+        }
+    }
+
+    const uint8_t bpp = _strip._bpp;
+    uint8_t* base = _strip._pixels + (uint32_t)_offset * bpp;
+    uint16_t i = 0, lo = UINT16_MAX, hi = 0;
+    bool ok = true;
+    while ((op >> 6) != OP_END) {
+        const uint8_t type = op >> 6;
+        const uint16_t n = (op & (OP_MAX - 1)) + 1;
+        if (i + n > _num_leds) { ok = false; break; }
+        if (type != OP_SKIP) {
+            uint8_t* p = base + (uint32_t)i * bpp;
+            if (type == OP_LITERAL) {
+                if (_read(p, (size_t)n * bpp) != (size_t)n * bpp) { ok = false; break; }
+                if (_reorder) _fixOrder(p, n);
+            } else {
+                if (_read(p, bpp) != bpp) { ok = false; break; }
+                if (_reorder) _fixOrder(p, 1);
+                for (uint16_t k = 1; k < n; k++) memcpy(p + k * bpp, p, bpp);
+            }
+            if (i < lo) lo = i;
+            hi = i + n;
+        }
+        i += n;
+        if (_read(&op, 1) != 1) { ok = false; break; }
+    }
+
+    if (lo < hi) _strip._markDirty(_offset + lo, _offset + hi);
+    if (!ok) {
+        _finished = true; // Обрезанные или битые данные
+        return false;
+    }
+    _frame++;
+    return true;
+}
+
+bool SavaAnimPlayer::update() {
+    if (_finished) return false;
+    uint32_t now = _strip.frameMicros(); // Одно время со всеми эффектами кадра
+    if (_frame && now - _last_us < _frame_us) return false;
+    // Отставание больше чем на кадр не догоняем - иначе кадры пойдут пачкой
+    _last_us = (_frame && now - _last_us < 2 * _frame_us) ? _last_us + _frame_us : now;
+    return nextFrame();
+}
@@ -0,0 +1,139 @@
+#ifndef SAVA_LED_ANIMATION_H
+#define SAVA_LED_ANIMATION_H
+
+#include "SavaLED_ESP32.h"
+
+/**
+ * Записанные анимации: кадры любого эффекта сохраняются в компактный поток и
+ * проигрываются без расчета эффекта - кадр стоит только распаковки.
+ *
+ * Формат: заголовок (16 байт), затем кадры. Кадр - последовательность команд над
+ * пикселями по порядку, байт команды = (тип << 6) | (кол-во пикселей - 1):
+ *   SKIP    (0) - n пикселей не изменились с прошлого кадра
+ *   LITERAL (1) - n пикселей, за командой n * bpp байтов
+ *   REPEAT  (2) - один пиксель (bpp байтов) повторяется n раз
+ *   END     (3) - конец кадра, оставшиеся пиксели не изменились
+ * Пиксели хранятся в порядке байтов ленты, на которой шла запись. Первый кадр
+ * записывается целиком, без SKIP, поэтому с него можно начать повтор.
+ *
+ *   SavaAnimPlayer player(strip);
+ *   File f = LittleFS.open("/scene.sava");
+ *   player.begin(f);
+ *   ...
+ *   if (strip.canShow()) {
+ *       player.update();   // Кадр по часам кадра ленты - они идут от show(),
+ *       strip.show();      // поэтому show() вызывается на каждом canShow(), как с эффектами
+ *   }
+ *
+ * Проигрыватель читает поток кусками по SAVA_ANIM_CHUNK байт и пишет прямо в буфер
+ * ленты. SKIP опирается на прошлый кадр в буфере, поэтому проигрывайте в режиме
+ * копирования (без setDoubleBuffer(true)) и не рисуйте поверх тех же пикселей.
+ */
+
+// --- Размер буфера чтения проигрывателя (для потока; данные из памяти читаются напрямую) ---
+#define SAVA_ANIM_CHUNK 256
+
+// Размер заголовка файла
+#define SAVA_ANIM_HEADER 16
+
+// --- Запись ---
+class SavaAnimRecorder {
+public:
+    SavaAnimRecorder() = default;
+    ~SavaAnimRecorder();
+    SavaAnimRecorder(const SavaAnimRecorder&) = delete;
+    SavaAnimRecorder& operator=(const SavaAnimRecorder&) = delete;
+
+    /**
+    * @brief Пишет заголовок в out (файл, Serial, буфер в памяти).
+    * @param frame_us Период кадра при воспроизведении, мкс (например, 1000000 / 60).
+    * @return false, если не хватило памяти под прошлый кадр (num_leds * bpp байт).
+    */
+    bool begin(Print& out, uint16_t num_leds, const SavaPixelFormat& format, uint32_t frame_us);
+    // То же с размером и форматом ленты
+    bool begin(Print& out, const SavaLED_ESP32& strip, uint32_t frame_us);
+
+    // Добавляет кадр: буфер в порядке байтов формата из begin()
+    bool addFrame(const uint8_t* pixels);
+    // Добавляет текущий буфер рисования ленты (до яркости и гаммы), не помечая его измененным
+    bool addFrame(const SavaLED_ESP32& strip);
+    void end();
+
+    uint32_t frames() const { return _frames; }
+    uint32_t bytesWritten() const { return _bytes; }
+
+private:
+    Print*   _out = nullptr;
+    uint8_t* _prev = nullptr;   // Прошлый кадр для SKIP
+    uint16_t _num_leds = 0;
+    uint8_t  _bpp = 3;
+    uint32_t _frames = 0;
+    uint32_t _bytes = 0;
+    bool     _failed = false;   // out принял не все байты
+
+    void _put(const uint8_t* data, size_t len);
+    void _run(uint8_t type, const uint8_t* pixels, uint16_t count);
+};
+
+// --- Воспроизведение ---
+class SavaAnimPlayer {
+public:
+    explicit SavaAnimPlayer(SavaLED_ESP32& strip) : _strip(strip) {}
+    SavaAnimPlayer(const SavaAnimPlayer&) = delete;
+    SavaAnimPlayer& operator=(const SavaAnimPlayer&) = delete;
+
+    /**
+    * @brief Читает заголовок из потока (файл SPIFFS/LittleFS/SD и т.п.).
+    *        Для повтора с начала: file.seek(0) и снова begin(file).
+    * @param offset Светодиод ленты, с которого рисуется анимация.
+    * @return false, если заголовок битый, bpp не совпадает с лентой или анимация не помещается.
+    */
+    bool begin(Stream& in, uint16_t offset = 0);
+    /**
+    * @brief Анимация в памяти: массив во флеше или раздел, отображенный esp_partition_mmap().
+    *        Чтение идет напрямую, без буфера.
+    */
+    bool begin(const uint8_t* data, size_t len, uint16_t offset = 0);
+
+    // Повтор с первого кадра по концу данных (только для begin() из памяти)
+    void setLoop(bool loop) { _loop = loop; }
+    /**
+    * @brief Распаковывает следующий кадр в буфер ленты, если по часам кадра ленты
+    *        (frameMicros()) подошло его время.
+    *        Часы обновляет show(): вызывайте его на каждом canShow(), даже без нового кадра.
+    * @return true, если кадр распакован.
+    */
+    bool update();
+    // Распаковывает следующий кадр сразу. false - конец анимации или битые данные
+    bool nextFrame();
+
+    bool finished() const { return _finished; }
+    uint32_t frameIndex() const { return _frame; }      // Сколько кадров распаковано
+    uint32_t frameInterval() const { return _frame_us; }
+    uint16_t numLeds() const { return _num_leds; }
+
+private:
+    SavaLED_ESP32& _strip;
+    Stream*        _in = nullptr;
+    const uint8_t* _data = nullptr;         // Источник в памяти
+    size_t         _size = 0;
+    size_t         _pos = 0;
+    uint8_t        _chunk[SAVA_ANIM_CHUNK]; // Буфер чтения из потока
+    uint16_t       _chunk_len = 0;
+    uint16_t       _chunk_pos = 0;
+    uint8_t        _order[4];               // Перестановка байтов пикселя файла -> ленты
+    bool           _reorder = false;
+    uint16_t       _offset = 0;
+    uint16_t       _num_leds = 0;
+    uint32_t       _frame_us = 0;
+    uint32_t       _frame = 0;
+    uint32_t       _last_us = 0;
+    bool           _loop = false;
+    bool           _finished = true;
+
+    bool   _header(const uint8_t* h);
+    size_t _read(uint8_t* dst, size_t len);
+    void   _fixOrder(uint8_t* p, uint16_t count) const;
+};
+
+#endif // SAVA_LED_ANIMATION_H
@@ -1,31 +1,19 @@
 #include "SavaLED_ESP32.h"
 #include "esp_log.h"
-
-// Константы таймингов, используются только здесь
-#define WS2812_T0H_NS 400
-#define WS2812_T0L_NS 850
-#define WS2812_T1H_NS 800
-#define WS2812_T1L_NS 450
-
-// --- Таблица гамма-коррекции ---
-const uint8_t SavaLED_ESP32::_gamma_table[256] = {
-  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
-  2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 4, 4, 4, 5,
-  5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 8, 8, 8, 8, 8,
-  9, 10, 10, 10, 10, 11, 11, 12, 12, 12, 12, 13, 13, 13, 14, 14,
-  15, 15, 15, 16, 17, 17, 17, 17, 18, 18, 19, 20, 20, 20, 20, 21,
-  22, 22, 23, 23, 23, 24, 25, 25, 26, 26, 27, 27, 28, 28, 29, 30,
-  30, 31, 31, 32, 33, 33, 34, 35, 35, 36, 37, 37, 38, 38, 39, 40,
-  41, 41, 42, 43, 44, 45, 45, 46, 47, 47, 48, 49, 50, 51, 52, 53,
-  54, 54, 55, 56, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67,
-  68, 69, 69, 70, 71, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 84,
-  85, 86, 87, 89, 90, 91, 93, 94, 95, 96, 97, 98, 100, 101, 102, 103,
-  105, 106, 108, 109, 110, 111, 113, 115, 117, 118, 119, 121, 122, 123, 124, 127,
-  128, 130, 131, 133, 134, 136, 137, 139, 140, 143, 145, 146, 147, 148, 151, 153,
-  154, 156, 158, 159, 162, 163, 165, 167, 169, 171, 173, 174, 176, 179, 180, 182,
-  185, 186, 188, 190, 192, 194, 196, 199, 201, 202, 205, 207, 209, 211, 214, 216,
-  218, 220, 223, 225, 226, 230, 231, 235, 236, 240, 241, 245, 246, 250, 251, 255
-};
+#include "esp_heap_caps.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+
+static const char* TAG = "SavaLED";
+// Кривая по умолчанию считается при компиляции
+static constexpr SavaGammaCurve DEFAULT_CURVE = savaGammaCurve(SAVA_DEFAULT_GAMMA);
+
+// Интервал с прошлого шага по часам кадра (не больше SAVA_MAX_STEP_US), last сдвигается на now
+static inline uint32_t _stepDt(uint32_t now, uint32_t& last) {
+    uint32_t dt = now - last;
+    last = now;
+    return dt > SAVA_MAX_STEP_US ? SAVA_MAX_STEP_US : dt;
+}
 
 // --- Таблица "Радужное Колесо" (3x256, R-G-B компоненты) ---
 const uint8_t SavaLED_ESP32::_rainbow_wheel[3][256] = {
@@ -78,24 +66,172 @@ const uint8_t SavaLED_ESP32::_rainbow_wheel[3][256] = {
 
 
 IRAM_ATTR bool SavaLED_ESP32::_rmt_tx_done_callback(rmt_channel_handle_t tx_chan, const rmt_tx_done_event_data_t *edata, void *user_ctx) {
-    SemaphoreHandle_t sem = (SemaphoreHandle_t)user_ctx;
+    SavaOutput* out = (SavaOutput*)user_ctx;
+    return out->owner->_outputDone(out);
+}
+
+// Кадр считается отправленным, когда его закончили ВСЕ выходы.
+// Возвращает true, если была разбужена задача с более высоким приоритетом.
+IRAM_ATTR bool SavaLED_ESP32::_outputDone(SavaOutput* out) {
     BaseType_t task_woken = pdFALSE;
-    xSemaphoreGiveFromISR(sem, &task_woken);
+    portENTER_CRITICAL_SAFE(&_tx_mux);
+    out->done++;
+    uint32_t frames_done = out->done;
+    for (uint8_t i = 0; i < _numOutputs; i++) {
+        if ((int32_t)(_outputs[i].done - frames_done) < 0) frames_done = _outputs[i].done;
+    }
+    uint32_t completed = frames_done - _frames_done;
+#if SAVA_ENABLE_STATS
+    if (completed) {
+        // Кадр начинает идти по проводу, когда отправлен в RMT и закончился предыдущий
+        int64_t now = esp_timer_get_time();
+        for (uint32_t f = _frames_done; f != frames_done; f++) {
+            int64_t start = _stats_submit_us[f % SAVA_MAX_PIPELINE];
+            if (start < _stats_last_done_us) start = _stats_last_done_us;
+            _timingAdd(_stats_wire, (uint32_t)(now - start));
+            _histAdd(_stats_hist[SAVA_STAGE_WIRE], (uint32_t)(now - start));
+            _stats_last_done_us = now;
+        }
+    }
+#endif
+    _frames_done = frames_done;
+    portEXIT_CRITICAL_SAFE(&_tx_mux);
+
+    while (completed--) {
+        xSemaphoreGiveFromISR(_tx_done_sem, &task_woken);
+    }
     return task_woken == pdTRUE;
 }
 
+#if SAVA_ENABLE_STATS
+// Накопление min/avg/max. Среднее - скользящее (вес 1/16), без деления и хранения истории.
+IRAM_ATTR void SavaLED_ESP32::_timingAdd(SavaTimingAcc& acc, uint32_t value) {
+    if (acc.count == 0) {
+        acc.min = acc.max = acc.avg = value;
+    } else {
+        if (value < acc.min) acc.min = value;
+        if (value > acc.max) acc.max = value;
+        acc.avg = (int32_t)acc.avg + (((int32_t)value - (int32_t)acc.avg) >> 4);
+    }
+    acc.count++;
+}
+
+// Корзина по старшему биту: время кадра от 1 мкс до десятков мс без деления
+IRAM_ATTR void SavaLED_ESP32::_histAdd(uint32_t* bins, uint32_t us) {
+    uint8_t bin = us < 2 ? 0 : 31 - __builtin_clz(us);
+    if (bin >= SAVA_STATS_BINS) bin = SAVA_STATS_BINS - 1;
+    bins[bin]++;
+}
+
+// Вызывается из show() перед передачей: время отрисовки, подготовки и частота кадров.
+void SavaLED_ESP32::_statsFrameSubmitted(uint32_t t_enter) {
+    uint32_t now_cycles = esp_cpu_get_cycle_count();
+    int64_t now_us = esp_timer_get_time();
+    uint32_t mhz = getCpuFrequencyMhz();
+
+    portENTER_CRITICAL(&_tx_mux);
+    if (_stats_frames) {
+        uint32_t render = t_enter - _stats_show_exit;
+        _timingAdd(_stats_render, render);
+        _histAdd(_stats_hist[SAVA_STAGE_RENDER], render / mhz);
+        _timingAdd(_stats_interval, (uint32_t)(now_us - _stats_submit_us[(_stats_frames - 1) % SAVA_MAX_PIPELINE]));
+    }
+    _timingAdd(_stats_prep, now_cycles - t_enter);
+    _histAdd(_stats_hist[SAVA_STAGE_PREP], (now_cycles - t_enter) / mhz);
+    // Номер кадра совпадает с номером, под которым его завершит _outputDone()
+    _stats_submit_us[_stats_frames % SAVA_MAX_PIPELINE] = now_us;
+    _stats_frames++;
+    portEXIT_CRITICAL(&_tx_mux);
+}
+#endif
+
+// Энкодер с коррекцией "на лету": каждый байт _pixels проходит через таблицу коррекции
+// в момент заполнения RMT-символов, отдельный буфер отправки не нужен.
+IRAM_ATTR size_t SavaLED_ESP32::_rmt_encode_callback(const void *data, size_t data_size, size_t symbols_written, size_t symbols_free, rmt_symbol_word_t *symbols, bool *done, void *arg) {
+    SavaOutput* out = (SavaOutput*)arg;
+    const SavaLED_ESP32* self = out->owner;
+    if (symbols_written == 0) {
+        // Начало кадра: таблица фиксируется на весь кадр, смена копии не режет его пополам
+        uint8_t idx = self->_enc_lut_idx;
+        out->lut = self->_enc_luts[idx];
+        out->lut_mono = self->_enc_lut_mono[idx];
+    }
+    const uint8_t (*lut)[256] = out->lut;
+    const bool mono = out->lut_mono;
+    const uint8_t* bytes = (const uint8_t*)data;
+    size_t pos = symbols_written / 8; // Каждый байт - ровно 8 символов
+    size_t written = 0;
+    const uint8_t bpp = self->_bpp;
+    uint8_t c = mono ? 0 : pos % bpp; // Таблица канала по положению байта в пикселе
+
+    while (pos < data_size && symbols_free - written >= 8) {
+        uint8_t v = lut[c][bytes[pos++]];
+        if (!mono && ++c == bpp) c = 0;
+        for (uint8_t mask = 0x80; mask; mask >>= 1) {
+            symbols[written++] = (v & mask) ? self->_bit1 : self->_bit0;
+        }
+    }
+    // Данные закончились - завершаем кадр сигналом сброса
+    if (pos >= data_size && symbols_free - written >= 1) {
+        symbols[written++] = self->_reset;
+        *done = true;
+    }
+    return written;
+}
+
 SavaLED_ESP32::SavaLED_ESP32() : 
     _numLeds(0), 
-    _pin(-1), 
     _brightness(255), 
     _isReady(false), 
     _pixels(nullptr),
-    _tx_buffer(nullptr),
-    _ledChannel(nullptr),
-    _ledEncoder(nullptr),
+    _pipeline_depth(1),
+    _tx_head(0),
+    _numOutputs(0),
+    _frames_done(0),
     _tx_done_sem(nullptr),
-	_gamma_enabled(true)
+    _num_layers(0),
+    _active_layer(-1),
+    _main_pixels(nullptr),
+    _main_dirty_lo(UINT16_MAX),
+    _main_dirty_hi(0),
+    _dirty_lo(UINT16_MAX),
+    _dirty_hi(0),
+    _refresh_all(true),
+    _skip_unchanged(false),
+    _keepalive_ms(0),
+    _last_tx_us(0),
+    _num_render_callbacks(0),
+    _render_task(nullptr),
+    _render_running(false),
+    _render_period(1),
+    _missed_frames(0),
+	_gamma_enabled(true),
+    _curve(DEFAULT_CURVE),
+    _correction{255, 255, 255, 255},
+    _lut_mono(true),
+    _lut_identity(false),
+    _dither(false),
+    _dither_err(nullptr),
+    _lut16(nullptr),
+    _curve16(nullptr),
+    _curve16_gamma(0),
+    _max_power_mw(0),
+    _power_mw(0),
+    _power_scale(256),
+    _double_buffer(false),
+    _encoder_correction(false),
+    _enc_luts(nullptr),
+    _enc_lut_mono{true, true},
+    _enc_lut_idx(0),
+    _enc_lut_stale(false),
+    _enc_lut_used{0, 0},
+    _frames_submitted(0),
+    _fmt(SAVA_GRB),
+    _bpp(3),
+    _white_mask(0)
 {
+    portMUX_INITIALIZE(&_tx_mux);
+    _rebuildLut();
 }
 
 SavaLED_ESP32::~SavaLED_ESP32() {
@@ -103,107 +239,418 @@ SavaLED_ESP32::~SavaLED_ESP32() {
 }
 
 void SavaLED_ESP32::_cleanup() {
-    if (_tx_done_sem && xSemaphoreTake(_tx_done_sem, pdMS_TO_TICKS(100)) == pdFAIL) {}
-    if (_pixels) { delete[] _pixels; _pixels = nullptr; }
-    if (_tx_buffer) { delete[] _tx_buffer; _tx_buffer = nullptr; }
-    if (_ledEncoder) { rmt_del_encoder(_ledEncoder); _ledEncoder = nullptr; }
-    if (_ledChannel) {
-        rmt_disable(_ledChannel);
-        rmt_del_channel(_ledChannel);
-        _ledChannel = nullptr;
+    stopRenderTask();
+    removeLayers();
+    removeSegments();
+    _freeTransitions();
+    for (uint8_t i = 0; i < SAVA_MAX_OUTPUTS; i++) {
+        SavaOutput& out = _outputs[i];
+        if (out.channel) rmt_tx_wait_all_done(out.channel, 100); // Дожидаемся всех кадров в очереди
     }
+    if (_pixels) { heap_caps_free(_pixels); _pixels = nullptr; }
+    if (_dither_err) { heap_caps_free(_dither_err); _dither_err = nullptr; }
+    if (_lut16) { heap_caps_free(_lut16); _lut16 = nullptr; }
+    if (_curve16) { heap_caps_free(_curve16); _curve16 = nullptr; }
+    _curve16_gamma = 0; // Новая _curve16 после begin() пересчитывается
+    if (_enc_luts) { heap_caps_free(_enc_luts); _enc_luts = nullptr; }
+    for (uint8_t i = 0; i < SAVA_MAX_PIPELINE; i++) {
+        if (_tx_frames[i]) { heap_caps_free(_tx_frames[i]); _tx_frames[i] = nullptr; }
+    }
+    for (uint8_t i = 0; i < SAVA_MAX_OUTPUTS; i++) {
+        SavaOutput& out = _outputs[i];
+        if (out.encoder) { rmt_del_encoder(out.encoder); out.encoder = nullptr; }
+        if (out.channel) {
+            rmt_disable(out.channel);
+            rmt_del_channel(out.channel);
+            out.channel = nullptr;
+        }
+    }
+    _numOutputs = 0;
     if (_tx_done_sem) { vSemaphoreDelete(_tx_done_sem); _tx_done_sem = nullptr; }
     _isReady = false;
 }
 
-bool SavaLED_ESP32::begin(uint16_t numLeds, int pin) {
+bool SavaLED_ESP32::begin(uint16_t numLeds, int pin, const SavaLEDConfig& config) {
+    return beginMulti(1, &pin, &numLeds, config);
+}
+
+// Буферы кадра читаются энкодером из ISR, поэтому держим их во внутренней RAM
+// (не PSRAM), а в режиме DMA - в DMA-совместимой области.
+uint8_t* SavaLED_ESP32::_allocBuffer(size_t size) {
+    uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    if (_config.with_dma) caps |= MALLOC_CAP_DMA;
+    return (uint8_t*)heap_caps_calloc(size, 1, caps);
+}
+
+bool SavaLED_ESP32::beginMulti(uint8_t numOutputs, const int pins[], const uint16_t counts[], const SavaLEDConfig& config) {
     if (_isReady) _cleanup();
+    if (numOutputs == 0 || numOutputs > SAVA_MAX_OUTPUTS) return false;
+    _config = config;
+    if (_config.format.bpp != 3 && _config.format.bpp != 4) return false;
+    _fmt = _config.format;
+    _bpp = _fmt.bpp;
+    _white_mask = (_bpp == 4) ? 0xFF : 0;
+    _pipeline_depth = constrain(_config.pipeline_depth, 1, SAVA_MAX_PIPELINE);
+    // Все кадры конвейера должны одновременно помещаться в очередь драйвера
+    if (_config.trans_queue_depth < _pipeline_depth) _config.trans_queue_depth = _pipeline_depth;
+    _tx_head = 0;
+    // Первый кадр готовится и передается целиком
+    for (uint8_t i = 0; i < SAVA_MAX_PIPELINE; i++) {
+        _slot_dirty_lo[i] = 0;
+        _slot_dirty_hi[i] = UINT16_MAX;
+        _slot_power_sum[i] = 0;
+    }
+    _rebuildLut(); // Коррекция каналов зависит от порядка байтов в пикселе
+
+    // Выходы делят один логический буфер: выход i начинается там, где закончился i-1.
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < numOutputs; i++) {
+        _outputs[i].owner = this;
+        _outputs[i].pin = pins[i];
+        _outputs[i].start = total;
+        _outputs[i].count = counts[i];
+        _outputs[i].done = 0;
+        total += counts[i];
+    }
+    if (total == 0 || total > 0xFFFF) return false;
+    _numLeds = total;
+    _numOutputs = numOutputs;
+    _frames_done = 0;
+    _frames_submitted = 0;
+#if SAVA_ENABLE_STATS
+    _stats_frames = 0;
+    _stats_last_done_us = 0;
+    resetStats();
+#endif
+
+    size_t buffer_size = (size_t)_numLeds * _bpp;
+    _pixels = _allocBuffer(buffer_size);
+    if (!_pixels) { _cleanup(); return false; }
+    if (_dither && !setDithering(true)) { _cleanup(); return false; }
+
+#if !SAVA_HAS_SIMPLE_ENCODER
+    _encoder_correction = false;
+#endif
+    if (_encoder_correction) {
+        // Обе копии таблицы энкодера сразу совпадают с _lut
+        _enc_luts = (uint8_t (*)[4][256])heap_caps_malloc(2 * sizeof(_lut), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!_enc_luts) { _cleanup(); return false; }
+        for (uint8_t i = 0; i < 2; i++) {
+            memcpy(_enc_luts[i], _lut, sizeof(_lut));
+            _enc_lut_mono[i] = _lut_mono;
+            _enc_lut_used[i] = 0;
+        }
+        _enc_lut_idx = 0;
+        _enc_lut_stale = false;
+    }
+    // Кольцо буферов отправки. В режиме коррекции в энкодере без конвейера
+    // лента передается прямо из _pixels и буферы отправки не нужны.
+    if (!_encoder_correction || _pipeline_depth > 1) {
+        for (uint8_t i = 0; i < _pipeline_depth; i++) {
+            _tx_frames[i] = _allocBuffer(buffer_size);
+            if (!_tx_frames[i]) { _cleanup(); return false; }
+        }
+    }
 
-    _numLeds = numLeds;
-    _pin = pin;
+    // Счетчик семафора = количество свободных мест в конвейере
+    _tx_done_sem = xSemaphoreCreateCounting(_pipeline_depth, _pipeline_depth);
+    if (!_tx_done_sem) { _cleanup(); return false; }
 
-    size_t buffer_size = _numLeds * 3;
-    _pixels = new (std::nothrow) uint8_t[buffer_size];
-    if (!_pixels) return false;
-    
-    _tx_buffer = new (std::nothrow) uint8_t[buffer_size];
-    if (!_tx_buffer) { _cleanup(); return false; }
+    const SavaChipTiming& t = _config.timing;
+    _bit0.duration0 = (uint32_t)(t.t0h_ns * 1ULL * RMT_LED_STRIP_RESOLUTION_HZ / 1000000000ULL);
+    _bit0.level0 = 1;
+    _bit0.duration1 = (uint32_t)(t.t0l_ns * 1ULL * RMT_LED_STRIP_RESOLUTION_HZ / 1000000000ULL);
+    _bit0.level1 = 0;
+    _bit1.duration0 = (uint32_t)(t.t1h_ns * 1ULL * RMT_LED_STRIP_RESOLUTION_HZ / 1000000000ULL);
+    _bit1.level0 = 1;
+    _bit1.duration1 = (uint32_t)(t.t1l_ns * 1ULL * RMT_LED_STRIP_RESOLUTION_HZ / 1000000000ULL);
+    _bit1.level1 = 0;
+    // Сигнал сброса (защелкивания) после кадра: низкий уровень на reset_us, делится на две половины символа
+    uint32_t reset_ticks = (uint32_t)(t.reset_us * 1ULL * RMT_LED_STRIP_RESOLUTION_HZ / 1000000ULL);
+    _reset.duration0 = reset_ticks / 2;
+    _reset.level0 = 0;
+    _reset.duration1 = reset_ticks - reset_ticks / 2;
+    _reset.level1 = 0;
+
+    for (uint8_t i = 0; i < _numOutputs; i++) {
+        if (!_beginOutput(_outputs[i])) { _cleanup(); return false; }
+    }
+
+    _txConfig = {.loop_count = 0};
+    _frame_us = micros();
+    _frame_dt_us = 0;
+    _isReady = true;
+    return true;
+}
 
-    memset(_pixels, 0, buffer_size);
+// --- Составной энкодер: байты кадра (bytes encoder) + сигнал сброса (copy encoder) ---
+// Сброс нужен, чтобы лента защелкнула кадр даже при отправке кадров вплотную (конвейер).
+struct SavaStripEncoder {
+    rmt_encoder_t base;
+    rmt_encoder_handle_t bytes_encoder;
+    rmt_encoder_handle_t copy_encoder;
+    rmt_symbol_word_t reset_code;
+    int state; // 0 - данные, 1 - сброс
+};
 
-    _tx_done_sem = xSemaphoreCreateBinary();
-    if (!_tx_done_sem) { _cleanup(); return false; }
-    xSemaphoreGive(_tx_done_sem);
+static IRAM_ATTR size_t _stripEncode(rmt_encoder_t* encoder, rmt_channel_handle_t channel,
+                                      const void* data, size_t data_size, rmt_encode_state_t* ret_state) {
+    SavaStripEncoder* enc = __containerof(encoder, SavaStripEncoder, base);
+    rmt_encode_state_t session = RMT_ENCODING_RESET;
+    int state = RMT_ENCODING_RESET;
+    size_t encoded = 0;
+    if (enc->state == 0) {
+        encoded += enc->bytes_encoder->encode(enc->bytes_encoder, channel, data, data_size, &session);
+        if (session & RMT_ENCODING_COMPLETE) enc->state = 1;
+        if (session & RMT_ENCODING_MEM_FULL) {
+            *ret_state = (rmt_encode_state_t)(state | RMT_ENCODING_MEM_FULL);
+            return encoded;
+        }
+    }
+    encoded += enc->copy_encoder->encode(enc->copy_encoder, channel, &enc->reset_code, sizeof(enc->reset_code), &session);
+    if (session & RMT_ENCODING_COMPLETE) {
+        enc->state = 0;
+        state |= RMT_ENCODING_COMPLETE;
+    }
+    if (session & RMT_ENCODING_MEM_FULL) state |= RMT_ENCODING_MEM_FULL;
+    *ret_state = (rmt_encode_state_t)state;
+    return encoded;
+}
+
+static esp_err_t _stripEncoderDel(rmt_encoder_t* encoder) {
+    SavaStripEncoder* enc = __containerof(encoder, SavaStripEncoder, base);
+    if (enc->bytes_encoder) rmt_del_encoder(enc->bytes_encoder);
+    if (enc->copy_encoder) rmt_del_encoder(enc->copy_encoder);
+    free(enc);
+    return ESP_OK;
+}
+
+static IRAM_ATTR esp_err_t _stripEncoderReset(rmt_encoder_t* encoder) {
+    SavaStripEncoder* enc = __containerof(encoder, SavaStripEncoder, base);
+    rmt_encoder_reset(enc->bytes_encoder);
+    rmt_encoder_reset(enc->copy_encoder);
+    enc->state = 0;
+    return ESP_OK;
+}
+
+static esp_err_t _newStripEncoder(rmt_symbol_word_t bit0, rmt_symbol_word_t bit1, rmt_symbol_word_t reset,
+                                  rmt_encoder_handle_t* ret) {
+    SavaStripEncoder* enc = (SavaStripEncoder*)calloc(1, sizeof(SavaStripEncoder));
+    if (!enc) return ESP_ERR_NO_MEM;
+    enc->base.encode = _stripEncode;
+    enc->base.del = _stripEncoderDel;
+    enc->base.reset = _stripEncoderReset;
+    enc->reset_code = reset;
+
+    rmt_bytes_encoder_config_t bytes_encoder_config = {
+        .bit0 = bit0,
+        .bit1 = bit1,
+        .flags = {.msb_first = 1}
+    };
+    rmt_copy_encoder_config_t copy_encoder_config = {};
+    if (rmt_new_bytes_encoder(&bytes_encoder_config, &enc->bytes_encoder) != ESP_OK ||
+        rmt_new_copy_encoder(&copy_encoder_config, &enc->copy_encoder) != ESP_OK) {
+        _stripEncoderDel(&enc->base);
+        return ESP_FAIL;
+    }
+    *ret = &enc->base;
+    return ESP_OK;
+}
 
+bool SavaLED_ESP32::_beginOutput(SavaOutput& out) {
     rmt_tx_channel_config_t tx_chan_config = {
-        .gpio_num = (gpio_num_t)_pin,
-        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .gpio_num = (gpio_num_t)out.pin,
+        .clk_src = _config.clk_src,
         .resolution_hz = RMT_LED_STRIP_RESOLUTION_HZ,
-        .mem_block_symbols = 64, 
-        .trans_queue_depth = 4,
-        .flags = {.invert_out = false, .with_dma = false}
+        .mem_block_symbols = _config.mem_block_symbols,
+        .trans_queue_depth = _config.trans_queue_depth,
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 2)
+        .intr_priority = _config.intr_priority,
+#endif
+        .flags = {.invert_out = false, .with_dma = _config.with_dma}
     };
     
-    esp_err_t err = rmt_new_tx_channel(&tx_chan_config, &_ledChannel);
-    if (err != ESP_OK) { _cleanup(); return false; }
-    
-     rmt_bytes_encoder_config_t bytes_encoder_config = {
-        .bit0 = {
-            .duration0 = (uint32_t)(WS2812_T0H_NS * 1ULL * RMT_LED_STRIP_RESOLUTION_HZ / 1000000000ULL),
-            .level0 = 1,
-            .duration1 = (uint32_t)(WS2812_T0L_NS * 1ULL * RMT_LED_STRIP_RESOLUTION_HZ / 1000000000ULL),
-            .level1 = 0,
-        },
-        .bit1 = {
-            .duration0 = (uint32_t)(WS2812_T1H_NS * 1ULL * RMT_LED_STRIP_RESOLUTION_HZ / 1000000000ULL),
-            .level0 = 1,
-            .duration1 = (uint32_t)(WS2812_T1L_NS * 1ULL * RMT_LED_STRIP_RESOLUTION_HZ / 1000000000ULL),
-            .level1 = 0,
-        },
-        .flags = {.msb_first = 1}
-    };
-
-    err = rmt_new_bytes_encoder(&bytes_encoder_config, &_ledEncoder);
-    if (err != ESP_OK) { _cleanup(); return false; }
+    esp_err_t err = rmt_new_tx_channel(&tx_chan_config, &out.channel);
+    if (err != ESP_OK && _config.with_dma) {
+        // DMA есть не на всех чипах и не у всех каналов (на S3 - только у одного TX канала).
+        ESP_LOGW(TAG, "RMT DMA недоступен для пина %d, используется обычный режим", out.pin);
+        tx_chan_config.flags.with_dma = false;
+        tx_chan_config.mem_block_symbols = 64; // Без DMA большой буфер символов недоступен
+        err = rmt_new_tx_channel(&tx_chan_config, &out.channel);
+    }
+    if (err != ESP_OK) return false;
+
+    // У каждого канала свой экземпляр энкодера: энкодер хранит состояние передачи.
+#if SAVA_HAS_SIMPLE_ENCODER
+    if (_encoder_correction) {
+        rmt_simple_encoder_config_t simple_encoder_config = {
+            .callback = _rmt_encode_callback,
+            .arg = &out,
+            .min_chunk_size = 8 // Один байт = 8 символов
+        };
+        err = rmt_new_simple_encoder(&simple_encoder_config, &out.encoder);
+    } else
+#endif
+    {
+        err = _newStripEncoder(_bit0, _bit1, _reset, &out.encoder);
+    }
+    if (err != ESP_OK) return false;
 
     rmt_tx_event_callbacks_t cbs = { .on_trans_done = _rmt_tx_done_callback };
-    err = rmt_tx_register_event_callbacks(_ledChannel, &cbs, _tx_done_sem);
-    if (err != ESP_OK) { _cleanup(); return false; }
+    err = rmt_tx_register_event_callbacks(out.channel, &cbs, &out);
+    if (err != ESP_OK) return false;
     
-    err = rmt_enable(_ledChannel);
-    if (err != ESP_OK) { _cleanup(); return false; }
-
-    _txConfig = {.loop_count = 0};
-    _isReady = true;
-    return true;
+    return rmt_enable(out.channel) == ESP_OK;
 }
 
 void SavaLED_ESP32::show() {
-    if (!_isReady || !canShow()) return;
+#if SAVA_ENABLE_STATS
+    uint32_t t_enter = esp_cpu_get_cycle_count();
+#endif
+    if (!_isReady) return;
+    if (!canShow()) {
+#if SAVA_ENABLE_STATS
+        _stats_dropped++;
+#endif
+        return;
+    }
     
     // Это происходит в начале отправки, подготавливая библиотеку к следующему кадру.
     _current_effect_slot = 0;
+    // Часы следующего кадра: одно время на все эффекты кадра
+    uint32_t now_us = micros();
+    _frame_dt_us = _stepDt(now_us, _frame_us);
+    if (_num_layers) {
+        drawToLayer(-1);
+        _composite();
+    }
+
+    // Кадр не изменился с прошлой передачи: при setSkipUnchanged() не передаем его,
+    // кроме периодического обновления раз в _keepalive_ms.
+    uint16_t dirty_lo = _dirty_lo, dirty_hi = _dirty_hi;
+    // Обмен буферов (двойной буфер, коррекция в энкодере с конвейером): после show() в буфере
+    // рисования старый кадр, готовить его нельзя - об изменениях судим только по рисованию
+    const bool swap = _tx_frames[0] && (_double_buffer || _encoder_correction);
+    // Дизеринг меняет выход каждого кадра, даже если рисования не было
+    bool dither = _dither_err && (!_lut_identity || _num_segments) && !_encoder_correction;
+    if (!swap && (_refresh_all || dither)) { dirty_lo = 0; dirty_hi = _numLeds; }
+    if (dirty_lo >= dirty_hi && _skip_unchanged) {
+        if (_keepalive_ms == 0 || now_us - _last_tx_us < (uint64_t)_keepalive_ms * 1000) {
+#if SAVA_ENABLE_STATS
+            _stats_skipped++;
+            _stats_show_exit = esp_cpu_get_cycle_count();
+#endif
+            return;
+        }
+        if (swap) {
+            // Повтор - последний отправленный слот как есть, кольцо не сдвигается: следующий
+            // слот освободится раньше повтора, RMT завершает кадры по очереди
+            _last_tx_us = now_us;
+            xSemaphoreTake(_tx_done_sem, 0);
+#if SAVA_ENABLE_STATS
+            _statsFrameSubmitted(t_enter);
+#endif
+            _transmit(_tx_frames[(_tx_head + _pipeline_depth - 1) % _pipeline_depth]);
+#if SAVA_ENABLE_STATS
+            _stats_show_exit = esp_cpu_get_cycle_count();
+#endif
+            return;
+        }
+    }
+    _dirty_lo = UINT16_MAX;
+    _dirty_hi = 0;
+    _refresh_all = false;
+    _last_tx_us = now_us;
 
     xSemaphoreTake(_tx_done_sem, 0);
 
-    size_t buffer_size = _numLeds * 3;
-    
-    if (_brightness < 255) {
-        for (uint32_t i = 0; i < buffer_size; i++) {
-            _tx_buffer[i] = ((uint16_t)_pixels[i] * _brightness) >> 8;
+    size_t buffer_size = (size_t)_numLeds * _bpp;
+    const uint8_t* frame = _pixels; // Коррекция в энкодере без конвейера: передаем прямо из _pixels.
+    bool measure = _max_power_mw != 0;
+    uint32_t power_sum = 0;
+    if (measure && _encoder_correction) {
+        // Коррекцию делает энкодер, своего прохода нет - считаем сумму отдельно
+        for (uint32_t i = 0, c = 0; i < buffer_size; i++) {
+            power_sum += _lut[c][_pixels[i]];
+            if (!_lut_mono && ++c == _bpp) c = 0;
         }
-    } else {
-        memcpy(_tx_buffer, _pixels, buffer_size);
     }
-    
-    if (_gamma_enabled) {
-        for (uint32_t i = 0; i < buffer_size; i++) {
-            _tx_buffer[i] = _gamma_table[_tx_buffer[i]];
+
+    if (_tx_frames[0]) {
+        // Каждый слот кольца помнит, что изменилось с момента его последней подготовки
+        for (uint8_t i = 0; i < _pipeline_depth; i++) {
+            if (dirty_lo < _slot_dirty_lo[i]) _slot_dirty_lo[i] = dirty_lo;
+            if (dirty_hi > _slot_dirty_hi[i]) _slot_dirty_hi[i] = dirty_hi;
+        }
+        // Следующий слот кольца гарантированно свободен: семафор не пускает
+        // больше _pipeline_depth кадров, а RMT завершает их строго по очереди.
+        uint8_t head = _tx_head;
+        uint8_t*& slot = _tx_frames[head];
+        uint16_t slot_lo = _slot_dirty_lo[_tx_head];
+        uint16_t slot_hi = _slot_dirty_hi[_tx_head] < _numLeds ? _slot_dirty_hi[_tx_head] : _numLeds;
+        _slot_dirty_lo[_tx_head] = UINT16_MAX;
+        _slot_dirty_hi[_tx_head] = 0;
+        _tx_head = (_tx_head + 1) % _pipeline_depth;
+
+        // Яркость и гамма объединены в таблицы (общую и сегментов), поэтому нужен максимум один проход.
+        if (_double_buffer || _encoder_correction) {
+            // Коррекция на месте (или в энкодере) и обмен указателей: копирования кадра нет вовсе.
+            if (!_encoder_correction) {
+                uint32_t old_sum;
+                power_sum = _prep(_pixels, _pixels, 0, buffer_size, dither, measure, old_sum);
+            }
+            uint8_t* drawn = _pixels;
+            _pixels = slot;
+            slot = drawn;
+        } else if (slot_lo < slot_hi) {
+            // Режим копирования: слот хранит свой прошлый кадр, готовим только изменившиеся пиксели
+            uint32_t from = (uint32_t)slot_lo * _bpp, to = (uint32_t)slot_hi * _bpp;
+            uint32_t old_sum, sum = _prep(slot, _pixels, from, to, dither, measure, old_sum);
+            if (measure) {
+                // Сумма кадра слота: полный проход задает ее заново, частичный - поправляет на свой диапазон
+                _slot_power_sum[head] = (from == 0 && to == buffer_size) ? sum : _slot_power_sum[head] - old_sum + sum;
+            }
         }
+        if (!_double_buffer && !_encoder_correction) power_sum = _slot_power_sum[head];
+        frame = slot;
     }
-    
-    if (rmt_transmit(_ledChannel, _ledEncoder, _tx_buffer, buffer_size, &_txConfig) != ESP_OK) {
-        xSemaphoreGive(_tx_done_sem);
+    if (measure) _updatePower(power_sum);
+
+#if SAVA_ENABLE_STATS
+    _statsFrameSubmitted(t_enter);
+#endif
+    _transmit(frame);
+#if SAVA_ENABLE_STATS
+    _stats_show_exit = esp_cpu_get_cycle_count();
+#endif
+}
+
+// Изменения _lut - в копию энкодера, которой не пользуется ни один кадр в очереди,
+// затем новые кадры переключаются на нее. Обе копии заняты - кадр идет со старой таблицей,
+// изменения попадут в один из следующих кадров.
+void SavaLED_ESP32::_syncEncoderLut() {
+    const uint8_t spare = _enc_lut_idx ^ 1;
+    if (_enc_lut_stale && (int32_t)(_frames_done - _enc_lut_used[spare]) >= 0) {
+        memcpy(_enc_luts[spare], _lut, _lut_mono ? sizeof(_lut[0]) : _bpp * sizeof(_lut[0]));
+        _enc_lut_mono[spare] = _lut_mono;
+        _enc_lut_stale = false;
+        _enc_lut_used[spare] = _frames_submitted + 1; // До переключения: ISR может взять копию сразу
+        _enc_lut_idx = spare;
+        return;
+    }
+    _enc_lut_used[_enc_lut_idx] = _frames_submitted + 1;
+}
+
+// Запускает передачу всех сегментов кадра подряд, без ожидания между ними.
+void SavaLED_ESP32::_transmit(const uint8_t* frame) {
+    if (_enc_luts) _syncEncoderLut();
+    _frames_submitted++;
+    for (uint8_t i = 0; i < _numOutputs; i++) {
+        SavaOutput& out = _outputs[i];
+        if (rmt_transmit(out.channel, out.encoder, frame + (size_t)out.start * _bpp, (size_t)out.count * _bpp, &_txConfig) != ESP_OK) {
+            // Передачи не будет - засчитываем выход сразу, чтобы кадр не "завис".
+            _outputDone(&out);
+        }
     }
 }
 
@@ -212,8 +659,414 @@ bool SavaLED_ESP32::canShow() const {
     return uxSemaphoreGetCount(_tx_done_sem) > 0;
 }
 
+bool SavaLED_ESP32::waitForFrame(uint32_t timeout_ms) {
+    if (!_isReady || !_tx_done_sem) return false;
+    // Спим на семафоре вместо опроса canShow(), место в конвейере возвращаем для show().
+    if (xSemaphoreTake(_tx_done_sem, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) return false;
+    xSemaphoreGive(_tx_done_sem);
+    return true;
+}
+
 void SavaLED_ESP32::setBrightness(uint8_t brightness) {
+    if (_brightness == brightness) return;
     _brightness = brightness;
+    _rebuildLut();
+}
+
+void SavaLED_ESP32::_rebuildLut() {
+    _refresh_all = true; // Новая таблица меняет каждый байт кадра
+    _enc_lut_stale = true;
+    if (_curve16 && _curve16_gamma != _curve.gamma) {
+        // Кривая с 8 дробными битами: выход 0..255.0 в 8.8, считается один раз на показатель
+        for (uint16_t i = 0; i < 256; i++) _curve16[i] = (uint16_t)(powf(i / 255.0f, _curve.gamma) * 65280.0f + 0.5f);
+        _curve16_gamma = _curve.gamma;
+    }
+    uint16_t weight[4];
+    _lut_mono = _channelWeights(nullptr, weight);
+    _fillLut(&_lut[0][0], _lut16, _lut_mono ? 1 : _bpp, _brightness, _gamma_enabled, weight);
+    _lut_identity = (_brightness == 255 && !_gamma_enabled && _power_scale == 256 && _lut_mono && weight[0] == 256);
+    for (uint8_t k = 0; k < _num_segments; k++) _buildSegmentLut(_segments[k]);
+}
+
+// Множители каналов 0..256 по положению байта в пикселе: коррекция цвета ленты,
+// для сегмента - еще и его баланс белого. true - множители всех каналов одинаковы.
+bool SavaLED_ESP32::_channelWeights(const uint8_t* balance, uint16_t weight[4]) const {
+    const uint8_t pos[4] = {_fmt.r, _fmt.g, _fmt.b, _fmt.w};
+    for (uint8_t c = 0; c < 4; c++) weight[c] = 256;
+    for (uint8_t k = 0; k < _bpp; k++) {
+        uint16_t w = savaWeight(_correction[k]);
+        if (balance) w = (w * savaWeight(balance[k])) >> 8;
+        weight[pos[k]] = w;
+    }
+    for (uint8_t c = 1; c < _bpp; c++) {
+        if (weight[c] != weight[0]) return false;
+    }
+    return true;
+}
+
+// Таблицы channels каналов подряд по 256: яркость -> гамма -> множитель канала -> ограничитель
+// мощности. Множители - после гаммы, чтобы мощность и цвет менялись пропорционально.
+// lut16 (если есть) - то же в 8.8 для дизеринга.
+void SavaLED_ESP32::_fillLut(uint8_t* lut, uint16_t* lut16, uint8_t channels, uint8_t bright, bool gamma, const uint16_t* weight) {
+    // Степенная кривая: (i * b)^g = i^g * b^g, поэтому яркость в 8.8 - один множитель к _curve16
+    uint32_t scale16 = 65536;
+    if (lut16 && gamma && bright < 255) scale16 = (uint32_t)(powf(bright / 256.0f, _curve.gamma) * 65536.0f + 0.5f);
+    for (uint8_t c = 0; c < channels; c++, lut += 256) {
+        const uint32_t w = (uint32_t)weight[c] * _power_scale; // 0..65536
+        for (uint16_t i = 0; i < 256; i++) {
+            uint8_t v = (bright < 255) ? (i * bright) >> 8 : i;
+            uint8_t out = gamma ? _curve.table[v] : v;
+            lut[i] = (out * w) >> 16;
+            if (!lut16) continue;
+            uint32_t x = gamma ? (_curve16[i] * scale16) >> 16 : ((bright < 255) ? i * bright : i << 8);
+            lut16[i] = ((uint64_t)x * w) >> 16;
+        }
+        if (lut16) lut16 += 256;
+    }
+}
+
+void SavaLED_ESP32::setGamma(float gamma) {
+    if (gamma <= 0 || gamma == _curve.gamma) return; // Кривая уже посчитана
+    _curve.gamma = gamma;
+    for (uint16_t i = 0; i < 256; i++) _curve.table[i] = (uint8_t)(powf(i / 255.0f, gamma) * 255.0f + 0.5f);
+    _rebuildLut();
+}
+
+void SavaLED_ESP32::setColorCorrection(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    _correction[0] = r;
+    _correction[1] = g;
+    _correction[2] = b;
+    _correction[3] = w;
+    _rebuildLut();
+}
+
+void SavaLED_ESP32::setColorProfile(const SavaColorProfile& profile) {
+    _curve = profile.curve;
+    _correction[0] = profile.r;
+    _correction[1] = profile.g;
+    _correction[2] = profile.b;
+    _correction[3] = profile.w;
+    _rebuildLut();
+}
+
+bool SavaLED_ESP32::setDithering(bool enabled) {
+    _dither = enabled;
+    if (!enabled) {
+        if (_dither_err) { heap_caps_free(_dither_err); _dither_err = nullptr; }
+        if (_lut16) { heap_caps_free(_lut16); _lut16 = nullptr; }
+        if (_curve16) { heap_caps_free(_curve16); _curve16 = nullptr; }
+        _curve16_gamma = 0;
+        for (uint8_t k = 0; k < _num_segments; k++) {
+            heap_caps_free(_segments[k].lut16);
+            _segments[k].lut16 = nullptr;
+        }
+        _refresh_all = true; // Слоты кольца хранят кадры с дизерингом
+        return true;
+    }
+    // Таблицы читаются в show() на каждый байт - во внутренней RAM
+    if (!_lut16) _lut16 = (uint16_t*)heap_caps_malloc(4 * 256 * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!_curve16) _curve16 = (uint16_t*)heap_caps_malloc(256 * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!_lut16 || !_curve16) { setDithering(false); return false; }
+    for (uint8_t k = 0; k < _num_segments; k++) {
+        if (!_allocSegmentLut16(_segments[k])) { setDithering(false); return false; }
+    }
+    _rebuildLut();
+    if (!_pixels || _dither_err) return true; // Буфер выделит begin()
+    size_t size = (size_t)_numLeds * _bpp;
+    _dither_err = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    if (!_dither_err) { setDithering(false); return false; }
+    // Начальные остатки разнесены по каналам (шаг ~ золотое сечение), чтобы пиксели
+    // одного цвета получали "лишнюю" единицу в разных кадрах, а не мигали разом.
+    for (size_t i = 0; i < size; i++) _dither_err[i] = (uint8_t)(i * 159);
+    return true;
+}
+
+// --- Ограничение мощности ---
+
+void SavaLED_ESP32::setPowerModel(const SavaPowerModel& model) {
+    _power_model = model;
+}
+
+void SavaLED_ESP32::setMaxPowerMilliwatts(uint32_t max_mw) {
+    _max_power_mw = max_mw;
+    _power_scale = 256;
+    _rebuildLut(); // Полный проход: суммы слотов не велись, пока ограничение было выключено
+}
+
+uint32_t SavaLED_ESP32::getPowerMilliwatts() const {
+    return _power_mw;
+}
+
+uint16_t SavaLED_ESP32::getPowerScale() const {
+    return _power_scale;
+}
+
+// Подготовка [from, to) с подсчетом суммы байтов кадра в том же проходе.
+// old_sum - сумма байтов, которые были в dst на этом месте (для поправки суммы слота).
+uint32_t SavaLED_ESP32::_prepMeasured(uint8_t* dst, const uint8_t* src, uint32_t from, uint32_t to, bool dither, uint32_t& old_sum) {
+    uint32_t sum = 0, old = 0;
+    if (dither) {
+        uint8_t* err = _dither_err;
+        for (uint32_t i = from; i < to; i++) {
+            uint16_t v = _lut16[src[i]] + err[i];
+            old += dst[i];
+            dst[i] = v >> 8;
+            err[i] = (uint8_t)v;
+            sum += v >> 8;
+        }
+    } else {
+        for (uint32_t i = from; i < to; i++) {
+            uint8_t v = _lut[0][src[i]];
+            old += dst[i];
+            dst[i] = v;
+            sum += v;
+        }
+    }
+    old_sum = old;
+    return sum;
+}
+
+// Оценка мощности по сумме байтов переданного кадра и новый множитель для следующих кадров
+void SavaLED_ESP32::_updatePower(uint32_t sum) {
+    const SavaPowerModel& m = _power_model;
+    // Байт v канала потребляет channel_ma * v / 255, мкВт = мкА * мВ / 1000
+    uint64_t led_uw = (uint64_t)sum * m.channel_ma * m.millivolts * 1000 / 255 / 1000;
+    uint64_t idle_uw = (uint64_t)_numLeds * m.idle_ua * m.millivolts / 1000;
+    _power_mw = (led_uw + idle_uw) / 1000;
+
+    uint64_t budget_uw = (uint64_t)_max_power_mw * 1000;
+    uint32_t target;
+    if (budget_uw <= idle_uw) {
+        target = 0;
+    } else if (led_uw == 0) {
+        target = 256; // Кадр черный (или погашен ограничителем) - оценить нельзя, снимаем ограничение
+    } else {
+        // Без ограничения кадр потреблял бы led_uw * 256 / scale
+        uint64_t t = (budget_uw - idle_uw) * _power_scale / led_uw;
+        target = t > 256 ? 256 : (uint32_t)t;
+    }
+    // Уменьшаем сразу, увеличиваем с запасом: дрожание оценки на единицу не пересчитывает таблицу каждый кадр
+    if (target < _power_scale || target >= _power_scale + 4u || (target == 256 && _power_scale != 256)) {
+        if (target != _power_scale) {
+            _power_scale = target;
+            _rebuildLut();
+        }
+    }
+}
+
+// Канал = _lut16[x] + остаток прошлого кадра: старший байт уходит на ленту, младший - в следующий кадр.
+// dst и src могут совпадать (коррекция на месте).
+void SavaLED_ESP32::_ditherRange(uint8_t* dst, const uint8_t* src, uint32_t from, uint32_t to) {
+    uint8_t* err = _dither_err;
+    for (uint32_t i = from; i < to; i++) {
+        uint16_t v = _lut16[src[i]] + err[i]; // Не больше 65280 + 255
+        dst[i] = v >> 8;
+        err[i] = (uint8_t)v;
+    }
+}
+
+// Подготовка [from, to) общими таблицами _lut (или _lut16 с дизерингом)
+uint32_t SavaLED_ESP32::_prepSpan(uint8_t* dst, const uint8_t* src, uint32_t from, uint32_t to, bool dither, bool measure, uint32_t& old_sum) {
+    old_sum = 0;
+    if (!_lut_mono) return _prepChannels(&_lut[0][0], _lut16, dst, src, from, to, dither, old_sum);
+    if (measure) return _prepMeasured(dst, src, from, to, dither, old_sum);
+    if (dither) {
+        _ditherRange(dst, src, from, to);
+    } else if (!_lut_identity) {
+        for (uint32_t i = from; i < to; i++) dst[i] = _lut[0][src[i]];
+    } else if (dst != src) {
+        memcpy(dst + from, src + from, to - from);
+    }
+    return 0;
+}
+
+// Подготовка [from, to) буфера отправки: участки между сегментами - общей таблицей,
+// сегменты - своими. Каждый байт проходит через одну таблицу ровно один раз.
+// Возвращает сумму байтов кадра (при measure), old_sum - сумма замененных байтов dst.
+uint32_t SavaLED_ESP32::_prep(uint8_t* dst, const uint8_t* src, uint32_t from, uint32_t to, bool dither, bool measure, uint32_t& old_sum) {
+    if (!_num_segments) return _prepSpan(dst, src, from, to, dither, measure, old_sum);
+    uint32_t sum = 0, old = 0, part_old;
+    uint32_t pos = from;
+    for (uint8_t k = 0; k < _num_segments && pos < to; k++) {
+        const OutputSegment& seg = _segments[_segment_order[k]];
+        uint32_t seg_from = (uint32_t)seg.start * _bpp;
+        uint32_t seg_to = seg_from + (uint32_t)seg.count * _bpp;
+        if (seg_to <= pos) continue;
+        if (seg_from >= to) break;
+        if (seg_from > pos) {
+            sum += _prepSpan(dst, src, pos, seg_from, dither, measure, part_old);
+            old += part_old;
+            pos = seg_from;
+        }
+        uint32_t end = seg_to < to ? seg_to : to;
+        sum += _prepChannels(seg.lut, seg.lut16, dst, src, pos, end, dither, part_old);
+        old += part_old;
+        pos = end;
+    }
+    if (pos < to) {
+        sum += _prepSpan(dst, src, pos, to, dither, measure, part_old);
+        old += part_old;
+    }
+    old_sum = old;
+    return sum;
+}
+
+// Подготовка таблицами по каналам [_bpp][256]: таблица выбирается по положению байта в пикселе
+// (from - начало пикселя). Сумма для ограничителя мощности считается всегда - два сложения на байт.
+uint32_t SavaLED_ESP32::_prepChannels(const uint8_t* lut, const uint16_t* lut16, uint8_t* dst, const uint8_t* src, uint32_t from, uint32_t to, bool dither, uint32_t& old_sum) {
+    const uint16_t wrap = (uint16_t)_bpp << 8;
+    uint16_t c = 0; // Смещение таблицы текущего канала
+    uint32_t sum = 0, old = 0;
+    if (dither && lut16) {
+        uint8_t* err = _dither_err;
+        for (uint32_t i = from; i < to; i++) {
+            uint16_t v = lut16[c + src[i]] + err[i];
+            old += dst[i];
+            dst[i] = v >> 8;
+            err[i] = (uint8_t)v;
+            sum += v >> 8;
+            c += 256;
+            if (c == wrap) c = 0;
+        }
+    } else {
+        for (uint32_t i = from; i < to; i++) {
+            uint8_t v = lut[c + src[i]];
+            old += dst[i];
+            dst[i] = v;
+            sum += v;
+            c += 256;
+            if (c == wrap) c = 0;
+        }
+    }
+    old_sum = old;
+    return sum;
+}
+
+// --- Сегменты вывода ---
+
+// Таблицы сегмента: общая яркость * яркость сегмента, своя гамма, коррекция ленты * баланс белого
+void SavaLED_ESP32::_buildSegmentLut(OutputSegment& seg) {
+    uint16_t weight[4];
+    _channelWeights(seg.balance, weight);
+    const uint8_t bright = ((uint16_t)_brightness * savaWeight(seg.brightness)) >> 8;
+    _fillLut(seg.lut, seg.lut16, _bpp, bright, seg.gamma, weight);
+}
+
+bool SavaLED_ESP32::_allocSegmentLut16(OutputSegment& seg) {
+    if (!seg.lut16) seg.lut16 = (uint16_t*)heap_caps_malloc((size_t)_bpp * 256 * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    return seg.lut16 != nullptr;
+}
+
+int8_t SavaLED_ESP32::addSegment(uint16_t start, uint16_t count, const char* name) {
+    if (!_isReady || _num_segments >= SAVA_MAX_SEGMENTS || !_clipRange(start, count)) return -1;
+    for (uint8_t k = 0; k < _num_segments; k++) {
+        const OutputSegment& other = _segments[k];
+        if (start < other.start + other.count && other.start < start + count) return -1;
+    }
+    OutputSegment& seg = _segments[_num_segments];
+    // Таблицы читаются в show() на каждый байт сегмента - держим во внутренней RAM
+    seg.lut = (uint8_t*)heap_caps_malloc((size_t)_bpp * 256, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    seg.lut16 = nullptr;
+    if (!seg.lut || (_dither && !_allocSegmentLut16(seg))) {
+        heap_caps_free(seg.lut);
+        seg.lut = nullptr;
+        return -1;
+    }
+    seg.start = start;
+    seg.count = count;
+    seg.name = name;
+    seg.brightness = 255;
+    seg.gamma = _gamma_enabled;
+    memset(seg.balance, 255, sizeof(seg.balance));
+    _buildSegmentLut(seg);
+
+    // Порядок обхода в show() - по возрастанию start
+    uint8_t k = _num_segments;
+    while (k && _segments[_segment_order[k - 1]].start > start) {
+        _segment_order[k] = _segment_order[k - 1];
+        k--;
+    }
+    _segment_order[k] = _num_segments;
+    _refresh_all = true;
+    return _num_segments++;
+}
+
+int8_t SavaLED_ESP32::findSegment(const char* name) const {
+    if (!name) return -1;
+    for (uint8_t k = 0; k < _num_segments; k++) {
+        if (_segments[k].name && !strcmp(_segments[k].name, name)) return k;
+    }
+    return -1;
+}
+
+void SavaLED_ESP32::removeSegments() {
+    for (uint8_t k = 0; k < _num_segments; k++) {
+        heap_caps_free(_segments[k].lut);
+        heap_caps_free(_segments[k].lut16);
+        _segments[k] = {};
+    }
+    if (_num_segments) _refresh_all = true;
+    _num_segments = 0;
+}
+
+void SavaLED_ESP32::setSegmentBrightness(int8_t id, uint8_t brightness) {
+    if (id < 0 || id >= (int8_t)_num_segments || _segments[id].brightness == brightness) return;
+    _segments[id].brightness = brightness;
+    _buildSegmentLut(_segments[id]);
+    _refresh_all = true;
+}
+
+void SavaLED_ESP32::setSegmentGamma(int8_t id, bool enabled) {
+    if (id < 0 || id >= (int8_t)_num_segments || _segments[id].gamma == enabled) return;
+    _segments[id].gamma = enabled;
+    _buildSegmentLut(_segments[id]);
+    _refresh_all = true;
+}
+
+void SavaLED_ESP32::setSegmentWhiteBalance(int8_t id, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    if (id < 0 || id >= (int8_t)_num_segments) return;
+    OutputSegment& seg = _segments[id];
+    seg.balance[0] = r;
+    seg.balance[1] = g;
+    seg.balance[2] = b;
+    seg.balance[3] = w;
+    _buildSegmentLut(seg);
+    _refresh_all = true;
+}
+
+void SavaLED_ESP32::setDoubleBuffer(bool enabled) {
+    if (_double_buffer == enabled) return;
+    _double_buffer = enabled;
+    // Слоты кольца после обмена указателей не хранят свой прошлый кадр
+    for (uint8_t i = 0; i < SAVA_MAX_PIPELINE; i++) {
+        _slot_dirty_lo[i] = 0;
+        _slot_dirty_hi[i] = UINT16_MAX;
+    }
+    _refresh_all = true;
+}
+
+void SavaLED_ESP32::setSkipUnchanged(bool enabled, uint32_t keepalive_ms) {
+    _skip_unchanged = enabled;
+    _keepalive_ms = keepalive_ms;
+}
+
+bool SavaLED_ESP32::hasChanges() const {
+    if (_refresh_all || _dirty_lo < _dirty_hi) return true;
+    if (_active_layer >= 0 && _main_dirty_lo < _main_dirty_hi) return true;
+    for (uint8_t i = 0; i < _num_layers; i++) {
+        if ((int8_t)i != _active_layer && _layers[i].dirty_lo < _layers[i].dirty_hi) return true;
+    }
+    return false;
+}
+
+void SavaLED_ESP32::setEncoderCorrection(bool enabled) {
+    if (_isReady) return; // Влияет на выделение буферов, меняется только до begin()
+    _encoder_correction = enabled;
+}
+
+uint8_t* SavaLED_ESP32::getPixels() {
+    _markAllDirty(); // Что именно изменят через указатель - неизвестно
+    return _pixels;
 }
 
 uint16_t SavaLED_ESP32::getNumLeds() const {
@@ -222,10 +1075,23 @@ uint16_t SavaLED_ESP32::getNumLeds() const {
 
 void SavaLED_ESP32::setPixel(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
     if (!_pixels || n >= _numLeds) return;
-    uint16_t idx = n * 3;
-    _pixels[idx]     = g;
-    _pixels[idx + 1] = r;
-    _pixels[idx + 2] = b;
+    _writePixel(_pixels + (uint32_t)n * _bpp, r, g, b);
+    _markDirty(n, n + 1);
+}
+
+void SavaLED_ESP32::setPixelRGBW(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    if (!_pixels || n >= _numLeds) return;
+    uint8_t* p = _pixels + (uint32_t)n * _bpp;
+    // Для форматов без W смещение W совпадает с R и тут же перезаписывается
+    p[_fmt.w] = w;
+    p[_fmt.r] = r;
+    p[_fmt.g] = g;
+    p[_fmt.b] = b;
+    _markDirty(n, n + 1);
+}
+
+void SavaLED_ESP32::setWhiteExtraction(bool enabled) {
+    _white_mask = (enabled && _bpp == 4) ? 0xFF : 0;
 }
 
 void SavaLED_ESP32::setPixel(uint16_t n, uint32_t color) {
@@ -243,14 +1109,140 @@ void SavaLED_ESP32::setPixelColor(uint16_t n, uint32_t color, uint8_t brightness
 void SavaLED_ESP32::clear() {
     //fill(0, 0, 0);
     if (!_pixels) return;
-    memset(_pixels, 0, _numLeds * 3);
+    memset(_pixels, 0, (size_t)_numLeds * _bpp);
+    _markAllDirty();
 }
 
 void SavaLED_ESP32::fill(uint8_t r, uint8_t g, uint8_t b) {
     if (!_pixels) return;
-    for (uint16_t i = 0; i < _numLeds; i++) {
-        setPixel(i, r, g, b);
+    _fillRange(0, _numLeds, r, g, b);
+}
+
+// --- Пакетная запись: границы проверяются один раз на весь диапазон ---
+
+// Обрезает [start, start + count) по длине ленты. false - диапазон пуст.
+bool SavaLED_ESP32::_clipRange(uint16_t start, uint16_t& count) const {
+    if (!_pixels || start >= _numLeds) return false;
+    if (count > _numLeds - start) count = _numLeds - start;
+    return count > 0;
+}
+
+// Заливка уже обрезанного диапазона. 12 байт шаблона = 4 пикселя RGB или 3 пикселя RGBW
+// = ровно 3 слова по 32 бита, поэтому основная часть пишется готовыми словами.
+void SavaLED_ESP32::_fillRange(uint16_t start, uint16_t count, uint8_t r, uint8_t g, uint8_t b) {
+    _markDirty(start, start + count);
+    uint8_t* p = _pixels + (uint32_t)start * _bpp;
+    if (r == g && g == b && _bpp == 3) {
+        memset(p, r, (uint32_t)count * _bpp);
+        return;
+    }
+
+    // Буфер выровнен на 4 байта: доводим начало до пикселя на границе слова
+    while (count && (((uint32_t)start * _bpp) & 3)) {
+        _writePixel(p, r, g, b);
+        p += _bpp; start++; count--;
+    }
+
+    uint8_t pattern[12];
+    _colorPattern(pattern, ((uint32_t)r << 16) | ((uint32_t)g << 8) | b);
+    uint32_t w0, w1, w2;
+    memcpy(&w0, pattern, 4);
+    memcpy(&w1, pattern + 4, 4);
+    memcpy(&w2, pattern + 8, 4);
+
+    const uint8_t per_pattern = 12 / _bpp;
+    uint32_t* w = (uint32_t*)p;
+    for (uint16_t blocks = count / per_pattern; blocks; blocks--) {
+        w[0] = w0; w[1] = w1; w[2] = w2;
+        w += 3;
+    }
+    p = (uint8_t*)w;
+    for (count %= per_pattern; count; count--) {
+        _writePixel(p, r, g, b);
+        p += _bpp;
+    }
+}
+
+void SavaLED_ESP32::fillRange(uint16_t start, uint16_t count, uint32_t color) {
+    if (!_clipRange(start, count)) return;
+    _fillRange(start, count, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF);
+}
+
+void SavaLED_ESP32::writePixels(uint16_t start, const uint32_t* colors, uint16_t count) {
+    if (!colors || !_clipRange(start, count)) return;
+    _markDirty(start, start + count);
+    uint8_t* p = _pixels + (uint32_t)start * _bpp;
+    for (uint16_t i = 0; i < count; i++, p += _bpp) {
+        uint32_t c = colors[i];
+        _writePixel(p, (c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+    }
+}
+
+void SavaLED_ESP32::writeRaw(uint16_t start, const uint8_t* data, uint16_t count) {
+    if (!data || !_clipRange(start, count)) return;
+    memcpy(_pixels + (uint32_t)start * _bpp, data, (uint32_t)count * _bpp);
+    _markDirty(start, start + count);
+}
+
+// --- Преобразования всего буфера ---
+
+// Шаблон из 12 байт (3 слова) для операций с постоянным цветом
+void SavaLED_ESP32::_colorPattern(uint8_t pattern[12], uint32_t color) const {
+    for (uint8_t i = 0; i < 12; i += _bpp) {
+        _writePixel(pattern + i, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF);
+    }
+}
+
+void SavaLED_ESP32::scalePixels(uint8_t scale) {
+    if (!_pixels) return;
+    savaScale(_pixels, (uint32_t)_numLeds * _bpp, scale);
+    _markAllDirty();
+}
+
+void SavaLED_ESP32::fadeToBlack(uint8_t amount) {
+    if (!_pixels || amount == 0) return;
+    savaScale(_pixels, (uint32_t)_numLeds * _bpp, 256 - savaWeight(amount));
+    _markAllDirty();
+}
+
+void SavaLED_ESP32::addColor(uint32_t color) {
+    if (!_pixels) return;
+    uint8_t pattern[12];
+    _colorPattern(pattern, color);
+    savaAddSatPattern(_pixels, (uint32_t)_numLeds * _bpp, pattern);
+    _markAllDirty();
+}
+
+void SavaLED_ESP32::blendColor(uint32_t color, uint8_t amount) {
+    if (!_pixels || amount == 0) return;
+    uint8_t pattern[12];
+    _colorPattern(pattern, color);
+    savaBlendPattern(_pixels, (uint32_t)_numLeds * _bpp, pattern, savaWeight(amount));
+    _markAllDirty();
+}
+
+// Для эффектов с направлением: обрезает шаги i отрезка, идущего от start вперед
+// (start + i) или назад (start - i), чтобы внутри цикла не было проверок границ.
+bool SavaLED_ESP32::_clipSpan(uint16_t start, uint16_t num, bool reversed, uint16_t& i_begin, uint16_t& i_end) const {
+    if (!_pixels || num == 0) return false;
+    int32_t b = 0, e = num;
+    if (reversed) {
+        if (start >= _numLeds) b = start - _numLeds + 1;
+        if (e > (int32_t)start + 1) e = start + 1;
+    } else {
+        if (start >= _numLeds) return false;
+        if (e > _numLeds - start) e = _numLeds - start;
     }
+    if (b >= e) return false;
+    i_begin = b;
+    i_end = e;
+    return true;
+}
+
+// Отмечает измененными пиксели шагов [i_begin, i_end) отрезка из _clipSpan()
+void SavaLED_ESP32::_markSpan(uint16_t start, uint16_t i_begin, uint16_t i_end, bool reversed) {
+    if (reversed) _markDirty(start - (i_end - 1), start - i_begin + 1);
+    else _markDirty(start + i_begin, start + i_end);
 }
 
 void SavaLED_ESP32::fill(uint32_t color) {
@@ -310,9 +1302,7 @@ void SavaLED_ESP32::fillHSV(uint8_t h, uint8_t s, uint8_t v) {
     }
     fill(r, g, b);
 }*/
-void SavaLED_ESP32::setPixelHSV(uint16_t n, uint8_t h, uint8_t s, uint8_t v) {
-    if (!_pixels || n >= _numLeds) return;
-
+uint32_t SavaLED_ESP32::ColorHSV(uint8_t h, uint8_t s, uint8_t v) {
     // 1. Берем готовые R, G, B компоненты из таблицы.
     uint8_t r = _rainbow_wheel[0][h];
     uint8_t g = _rainbow_wheel[1][h];
@@ -333,36 +1323,341 @@ void SavaLED_ESP32::setPixelHSV(uint16_t n, uint8_t h, uint8_t s, uint8_t v) {
         g = ((g * S) + (V * (255 - S))) >> 8;
         b = ((b * S) + (V * (255 - S))) >> 8;
     }
-    
-    // 4. Устанавливаем итоговый цвет.
-    setPixel(n, r, g, b);
+    return Color(r, g, b);
+}
+
+void SavaLED_ESP32::setPixelHSV(uint16_t n, uint8_t h, uint8_t s, uint8_t v) {
+    if (!_pixels || n >= _numLeds) return;
+    setPixel(n, ColorHSV(h, s, v));
 }
 
 void SavaLED_ESP32::fillHSV(uint8_t h, uint8_t s, uint8_t v) {
-    // Та же логика, что и выше, но для одного цвета,
-    // который затем используется для заливки.
-    uint8_t r = _rainbow_wheel[0][h];
-    uint8_t g = _rainbow_wheel[1][h];
-    uint8_t b = _rainbow_wheel[2][h];
+    fill(ColorHSV(h, s, v));
+}
 
-    if (v != 255) {
-        r = ((uint16_t)r * v) >> 8;
-        g = ((uint16_t)g * v) >> 8;
-        b = ((uint16_t)b * v) >> 8;
+void SavaLED_ESP32::setGammaCorrection(bool enabled) {
+    if (_gamma_enabled == enabled) return;
+    _gamma_enabled = enabled;
+    _rebuildLut();
+}
+
+// --- Слои ---
+
+int8_t SavaLED_ESP32::addLayer(SavaBlendMode mode, uint8_t opacity) {
+    if (!_isReady || _num_layers >= SAVA_MAX_LAYERS) return -1;
+    // Слои не читаются из ISR, поэтому подойдет любая 8-битная память
+    uint8_t* pixels = (uint8_t*)heap_caps_calloc((size_t)_numLeds * _bpp, 1, MALLOC_CAP_8BIT);
+    if (!pixels) return -1;
+    SavaLayer& layer = _layers[_num_layers];
+    layer.pixels = pixels;
+    layer.mode = mode;
+    layer.opacity = opacity;
+    layer.visible = true;
+    layer.dirty_lo = 0;
+    layer.dirty_hi = _numLeds;
+    return _num_layers++;
+}
+
+void SavaLED_ESP32::removeLayers() {
+    drawToLayer(-1);
+    for (uint8_t i = 0; i < _num_layers; i++) {
+        heap_caps_free(_layers[i].pixels);
+        _layers[i].pixels = nullptr;
     }
-    if (s != 255) {
-        uint8_t V = v;
-        uint8_t S = s;
-        r = ((r * S) + (V * (255 - S))) >> 8;
-        g = ((g * S) + (V * (255 - S))) >> 8;
-        b = ((b * S) + (V * (255 - S))) >> 8;
+    _num_layers = 0;
+}
+
+bool SavaLED_ESP32::drawToLayer(int8_t id) {
+    if (id >= (int8_t)_num_layers || id < -1) return false;
+    if (id == _active_layer) return true;
+    // Сохраняем измененный диапазон текущего буфера рисования...
+    if (_active_layer < 0) {
+        _main_pixels = _pixels;
+        _main_dirty_lo = _dirty_lo;
+        _main_dirty_hi = _dirty_hi;
+    } else {
+        _layers[_active_layer].dirty_lo = _dirty_lo;
+        _layers[_active_layer].dirty_hi = _dirty_hi;
+    }
+    // ...и переключаемся на новый
+    if (id < 0) {
+        _pixels = _main_pixels;
+        _dirty_lo = _main_dirty_lo;
+        _dirty_hi = _main_dirty_hi;
+    } else {
+        _pixels = _layers[id].pixels;
+        _dirty_lo = _layers[id].dirty_lo;
+        _dirty_hi = _layers[id].dirty_hi;
     }
+    _active_layer = id;
+    return true;
+}
 
-    fill(r, g, b);
+void SavaLED_ESP32::setLayerMode(int8_t id, SavaBlendMode mode) {
+    if (id < 0 || id >= (int8_t)_num_layers || _layers[id].mode == mode) return;
+    _layers[id].mode = mode;
+    _layers[id].dirty_lo = 0;
+    _layers[id].dirty_hi = _numLeds;
 }
 
-void SavaLED_ESP32::setGammaCorrection(bool enabled) {
-    _gamma_enabled = enabled;
+void SavaLED_ESP32::setLayerOpacity(int8_t id, uint8_t opacity) {
+    if (id < 0 || id >= (int8_t)_num_layers || _layers[id].opacity == opacity) return;
+    _layers[id].opacity = opacity;
+    _layers[id].dirty_lo = 0;
+    _layers[id].dirty_hi = _numLeds;
+}
+
+void SavaLED_ESP32::setLayerVisible(int8_t id, bool visible) {
+    if (id < 0 || id >= (int8_t)_num_layers || _layers[id].visible == visible) return;
+    _layers[id].visible = visible;
+    _layers[id].dirty_lo = 0;
+    _layers[id].dirty_hi = _numLeds;
+}
+
+uint8_t SavaLED_ESP32::getNumLayers() const {
+    return _num_layers;
+}
+
+// Накладывает слои в основной буфер. Результат прошлого кадра в основном буфере
+// сохраняется, поэтому пересчитывается только объединение измененных диапазонов слоев.
+// Вызывается из show(), когда рисование уже возвращено в основной буфер.
+void SavaLED_ESP32::_composite() {
+    uint16_t lo = UINT16_MAX, hi = 0;
+    for (uint8_t i = 0; i < _num_layers; i++) {
+        SavaLayer& layer = _layers[i];
+        if (layer.dirty_lo < lo) lo = layer.dirty_lo;
+        if (layer.dirty_hi > hi) hi = layer.dirty_hi;
+        layer.dirty_lo = UINT16_MAX;
+        layer.dirty_hi = 0;
+    }
+    // Двойная буферизация (и коррекция в энкодере с конвейером) подменяет основной буфер
+    // после show(): прошлого результата в нем нет, собираем кадр целиком.
+    if (_tx_frames[0] && (_double_buffer || _encoder_correction)) { lo = 0; hi = _numLeds; }
+    if (lo >= hi) return;
+
+    size_t offset = (size_t)lo * _bpp;
+    size_t len = (size_t)(hi - lo) * _bpp;
+    uint8_t* dst = _pixels + offset;
+    memset(dst, 0, len);
+    for (uint8_t i = 0; i < _num_layers; i++) {
+        const SavaLayer& layer = _layers[i];
+        if (!layer.visible || layer.opacity == 0) continue;
+        const uint8_t* src = layer.pixels + offset;
+        uint16_t w = savaWeight(layer.opacity);
+        switch (layer.mode) {
+            case SAVA_BLEND_KEYED:    savaLayerKeyed(dst, src, len, _bpp, w); break;
+            case SAVA_BLEND_ADD:      savaLayerAdd(dst, src, len, w); break;
+            case SAVA_BLEND_MAX:      savaLayerMax(dst, src, len, w); break;
+            case SAVA_BLEND_MULTIPLY: savaLayerMultiply(dst, src, len, w); break;
+            case SAVA_BLEND_SCREEN:   savaLayerScreen(dst, src, len, w); break;
+        }
+    }
+    _markDirty(lo, hi);
+}
+
+// --- Планировщик эффектов ---
+
+int8_t SavaLED_ESP32::addEffect(SavaEffect& effect, uint16_t start, uint16_t count, bool reversed, int8_t layer) {
+    for (uint8_t i = 0; i < SAVA_MAX_EFFECTS; i++) {
+        EffectSlot& slot = _effects[i];
+        if (slot.effect) continue;
+        slot.effect = &effect;
+        slot.seg = {start, count, reversed};
+        slot.layer = layer;
+        slot.redraw = true;
+        slot.last_update = _frame_us;
+        slot.transition = nullptr;
+        if (i >= _num_effects) _num_effects = i + 1;
+        return i;
+    }
+    return -1;
+}
+
+void SavaLED_ESP32::removeEffect(int8_t id) {
+    if (id < 0 || id >= (int8_t)_num_effects) return;
+    if (_effects[id].transition) _effects[id].transition->active = false;
+    _effects[id].effect = nullptr;
+    _effects[id].transition = nullptr;
+    while (_num_effects && !_effects[_num_effects - 1].effect) _num_effects--;
+}
+
+void SavaLED_ESP32::clearEffects() {
+    for (uint8_t i = 0; i < _num_effects; i++) {
+        _effects[i].effect = nullptr;
+        _effects[i].transition = nullptr;
+    }
+    for (uint8_t i = 0; i < SAVA_MAX_TRANSITIONS; i++) _transitions[i].active = false;
+    _num_effects = 0;
+}
+
+// Шаг эффекта по часам кадра, если истек его interval_ms
+bool SavaLED_ESP32::_stepEffect(SavaEffect& effect, uint32_t& last_update, const SavaSegment& seg) {
+    SavaTime t = {_frame_us, 0};
+    uint32_t elapsed = t.now_us - last_update;
+    if (!elapsed || elapsed < effect.interval_ms * 1000UL) return false;
+    t.dt_us = _stepDt(t.now_us, last_update);
+    return effect.update(t, seg);
+}
+
+void SavaLED_ESP32::runEffects() {
+    if (!_pixels) return;
+    int8_t prev_layer = _active_layer;
+    for (uint8_t i = 0; i < _num_effects; i++) {
+        EffectSlot& slot = _effects[i];
+        if (!slot.effect) continue;
+        if (slot.transition && _runTransition(slot)) continue;
+        // После двойной буферизации буфер рисования пуст - перерисовываем все
+        bool changed = slot.redraw || _double_buffer;
+        changed |= _stepEffect(*slot.effect, slot.last_update, slot.seg);
+        if (!changed || !drawToLayer(slot.layer)) continue;
+        slot.effect->draw(*this, slot.seg);
+        slot.redraw = false;
+    }
+    drawToLayer(prev_layer);
+}
+
+// --- Переходы между эффектами ---
+
+bool SavaLED_ESP32::transitionEffect(int8_t id, SavaEffect& next, SavaTransition type, uint16_t duration_ms) {
+    if (id < 0 || id >= (int8_t)_num_effects || !_effects[id].effect) return false;
+    EffectSlot& slot = _effects[id];
+    // Новый переход во время текущего начинается от входящего эффекта
+    if (slot.transition) _endTransition(slot);
+
+    const bool cut = type == SAVA_TRANSITION_CUT || duration_ms == 0;
+    EffectTransition* tr = nullptr;
+    if (!cut && _pixels) {
+        for (uint8_t i = 0; i < SAVA_MAX_TRANSITIONS; i++) {
+            if (!_transitions[i].active) { tr = &_transitions[i]; break; }
+        }
+        // Буферы пула выделяются при первом использовании и не освобождаются до end().
+        // Из ISR они не читаются, поэтому подойдет любая 8-битная память.
+        if (tr && !tr->from) {
+            size_t size = (size_t)_numLeds * _bpp;
+            tr->from = (uint8_t*)heap_caps_calloc(size, 1, MALLOC_CAP_8BIT);
+            tr->to = (uint8_t*)heap_caps_calloc(size, 1, MALLOC_CAP_8BIT);
+            if (!tr->from || !tr->to) {
+                heap_caps_free(tr->from);
+                heap_caps_free(tr->to);
+                tr->from = tr->to = nullptr;
+                tr = nullptr;
+            }
+        }
+    }
+    if (!tr) {
+        slot.effect = &next;
+        slot.last_update = _frame_us;
+        slot.redraw = true;
+        return cut;
+    }
+
+    // Уходящий эффект продолжает с текущей картинки места, входящий рисует с черного
+    uint16_t start = slot.seg.start, count = slot.seg.count;
+    if (_clipRange(start, count) && slot.layer < (int8_t)_num_layers) {
+        const uint8_t* current = slot.layer == _active_layer ? _pixels
+                               : slot.layer < 0 ? _main_pixels : _layers[slot.layer].pixels;
+        size_t offset = (size_t)start * _bpp, len = (size_t)count * _bpp;
+        memcpy(tr->from + offset, current + offset, len);
+        memset(tr->to + offset, 0, len);
+    }
+    tr->next = &next;
+    tr->next_update = _frame_us;
+    tr->start_us = _frame_us;
+    tr->duration_us = duration_ms * 1000UL;
+    tr->type = type;
+    tr->active = true;
+    tr->redraw = true;
+    slot.transition = tr;
+    return true;
+}
+
+bool SavaLED_ESP32::isTransitioning(int8_t id) const {
+    return id >= 0 && id < (int8_t)_num_effects && _effects[id].transition;
+}
+
+// Завершает переход: место переходит к входящему эффекту, буферы возвращаются в пул
+void SavaLED_ESP32::_endTransition(EffectSlot& slot) {
+    EffectTransition& tr = *slot.transition;
+    slot.effect = tr.next;
+    slot.last_update = tr.next_update;
+    slot.redraw = true;
+    tr.active = false;
+    slot.transition = nullptr;
+}
+
+void SavaLED_ESP32::_freeTransitions() {
+    for (uint8_t i = 0; i < _num_effects; i++) {
+        if (_effects[i].transition) _endTransition(_effects[i]);
+    }
+    for (uint8_t i = 0; i < SAVA_MAX_TRANSITIONS; i++) {
+        heap_caps_free(_transitions[i].from);
+        heap_caps_free(_transitions[i].to);
+        _transitions[i] = {};
+    }
+}
+
+// Кадр перехода: оба эффекта рисуют в свои буферы, смесь - в буфер места.
+// false - переход закончился, место уже рисует входящий эффект.
+bool SavaLED_ESP32::_runTransition(EffectSlot& slot) {
+    EffectTransition& tr = *slot.transition;
+    uint32_t elapsed = _frame_us - tr.start_us;
+    if (elapsed >= tr.duration_us) {
+        _endTransition(slot);
+        return false;
+    }
+    if (!drawToLayer(slot.layer)) return true;
+
+    // Буфер рисования подменяется на время отрисовки эффектов, как в drawToLayer()
+    uint8_t* target = _pixels;
+    uint16_t dirty_lo = _dirty_lo, dirty_hi = _dirty_hi;
+    bool from_changed = _stepEffect(*slot.effect, slot.last_update, slot.seg) || tr.redraw;
+    bool to_changed = _stepEffect(*tr.next, tr.next_update, slot.seg) || tr.redraw;
+    if (from_changed) {
+        _pixels = tr.from;
+        slot.effect->draw(*this, slot.seg);
+    }
+    if (to_changed) {
+        _pixels = tr.to;
+        tr.next->draw(*this, slot.seg);
+    }
+    _pixels = target;
+    _dirty_lo = dirty_lo;
+    _dirty_hi = dirty_hi;
+    tr.redraw = false;
+
+    uint16_t start = slot.seg.start, count = slot.seg.count;
+    if (!_clipRange(start, count)) return true;
+    const uint16_t w = (uint64_t)elapsed * 256 / tr.duration_us; // Доля входящего эффекта 0..255
+    const size_t offset = (size_t)start * _bpp, len = (size_t)count * _bpp;
+    uint8_t* dst = target + offset;
+    const uint8_t* a = tr.from + offset;
+    const uint8_t* b = tr.to + offset;
+    switch (tr.type) {
+        case SAVA_TRANSITION_WIPE: {
+            size_t k = (size_t)(((uint32_t)count * w) >> 8) * _bpp; // Байты входящего эффекта
+            if (slot.seg.reversed) {
+                memcpy(dst, a, len - k);
+                memcpy(dst + len - k, b + len - k, k);
+            } else {
+                memcpy(dst, b, k);
+                memcpy(dst + k, a + k, len - k);
+            }
+            break;
+        }
+        case SAVA_TRANSITION_DISSOLVE:
+            for (uint16_t i = 0; i < count; i++) {
+                // Порог пикселя - хеш его номера: порядок смены случайный, но одинаковый в каждом кадре
+                uint8_t threshold = ((uint32_t)(start + i) * 2654435761UL) >> 24;
+                size_t o = (size_t)i * _bpp;
+                memcpy(dst + o, (threshold < w ? b : a) + o, _bpp);
+            }
+            break;
+        default:
+            savaMix(dst, a, b, len, w);
+            break;
+    }
+    _markDirty(start, start + count);
+    return true;
 }
 
 // --- НЕБЛОКИРУЮЩИЕ ЭФФЕКТЫ ---
@@ -376,43 +1671,74 @@ void SavaLED_ESP32::rainbowCycle(uint16_t speed, uint8_t brightness) {
 
 void SavaLED_ESP32::rainbowCycle(uint16_t start_pixel, uint16_t num_pixels, bool reversed, uint16_t speed, uint8_t brightness) {
     // Проверяем, не вышли ли мы за пределы выделенных слотов
-    if (_current_effect_slot >= 5) return;
+    if (_current_effect_slot >= SAVA_MAX_EFFECTS) {
+        if (_current_effect_slot++ == SAVA_MAX_EFFECTS) {
+            ESP_LOGW(TAG, "rainbowCycle(): больше %d вызовов за кадр, лишние пропущены", SAVA_MAX_EFFECTS);
+        }
+        return;
+    }
 
     // Получаем ссылку на состояние для ТЕКУЩЕГО вызова
     EffectState& state = _effect_slots[_current_effect_slot];
 
     if (speed == 0) return;
 
-    uint32_t frame_delay = map(speed, 1, 255, 50, 1);
-    if (millis() - state.last_update < frame_delay) {
-        // Если для этого слота время еще не пришло, мы все равно должны нарисовать его старое состояние!
-        // Иначе он будет "моргать". Поэтому `return` убираем.
-    } else {
-        state.last_update = millis();
-        state.counter++; // Продвигаем анимацию только для этого слота
-    }
+    // Продвигаем анимацию только для этого слота - по часам кадра, независимо от FPS.
+    // Старое состояние рисуем и без смены шага, иначе отрезок будет "моргать".
+    state.phase.rate = savaSpeedToRate(speed);
+    state.phase.advance(_stepDt(_frame_us, state.last_update));
 
-    // Рисуем кадр, используя `state.counter` из нашего слота
-    for (uint16_t i = 0; i < num_pixels; i++) {
-        int pixel_index;
-        if (reversed) {
-            pixel_index = start_pixel - i;
-        } else {
-            pixel_index = start_pixel + i;
-        }
-
-        if (pixel_index < 0 || pixel_index >= _numLeds) {
-            continue; 
-        }
-
-        uint8_t hue = ((i * 256) / num_pixels) - state.counter;
-        setPixelHSV(pixel_index, hue, 255, brightness);
-    }
+    // Рисуем кадр, используя фазу из нашего слота
+    _drawRainbow(start_pixel, num_pixels, reversed, state.phase.step(), brightness);
     
     // Переключаемся на следующий слот для следующего вызова эффекта В ЭТОМ ЖЕ КАДРЕ
     _current_effect_slot++;
 }
 
+// Радуга на отрезке, сдвинутая на offset по тону (общая для rainbowCycle() и SavaRainbowCycleEffect)
+void SavaLED_ESP32::_drawRainbow(uint16_t start_pixel, uint16_t num_pixels, bool reversed, uint8_t offset, uint8_t brightness) {
+    uint16_t i_begin, i_end;
+    if (!_clipSpan(start_pixel, num_pixels, reversed, i_begin, i_end)) return;
+    _markSpan(start_pixel, i_begin, i_end, reversed);
+    int step = reversed ? -_bpp : _bpp;
+    uint8_t* p = _pixels + (uint32_t)(reversed ? start_pixel - i_begin : start_pixel + i_begin) * _bpp;
+    // (i * 256) / num_pixels считаем приращениями частного и остатка, без деления на пиксель
+    uint32_t q = (uint32_t)i_begin * 256 / num_pixels;
+    uint32_t rem = (uint32_t)i_begin * 256 % num_pixels;
+    const uint32_t q_step = 256 / num_pixels, rem_step = 256 % num_pixels;
+
+    for (uint16_t i = i_begin; i < i_end; i++, p += step) {
+        _writeHSV(p, (uint8_t)q - offset, brightness);
+        q += q_step;
+        rem += rem_step;
+        if (rem >= num_pixels) { rem -= num_pixels; q++; }
+    }
+}
+
+void SavaLED_ESP32::fillPalette(uint16_t start_pixel, uint16_t num_pixels, const SavaPalette& palette, bool reversed,
+                                uint8_t brightness, uint8_t offset) {
+    uint16_t i_begin, i_end;
+    if (!_clipSpan(start_pixel, num_pixels, reversed, i_begin, i_end)) return;
+    _markSpan(start_pixel, i_begin, i_end, reversed);
+    const uint8_t* lut = palette.lut();
+    uint16_t w = savaWeight(brightness);
+    int step = reversed ? -_bpp : _bpp;
+    uint8_t* p = _pixels + (uint32_t)(reversed ? start_pixel - i_begin : start_pixel + i_begin) * _bpp;
+    // Индекс (i * 256) / num_pixels + offset - приращениями частного и остатка, как в _drawRainbow()
+    uint32_t q = (uint32_t)i_begin * 256 / num_pixels;
+    uint32_t rem = (uint32_t)i_begin * 256 % num_pixels;
+    const uint32_t q_step = 256 / num_pixels, rem_step = 256 % num_pixels;
+
+    for (uint16_t i = i_begin; i < i_end; i++, p += step) {
+        const uint8_t* c = lut + (uint8_t)(q + offset) * 3;
+        if (brightness == 255) _writePixel(p, c[0], c[1], c[2]);
+        else _writePixel(p, (c[0] * w) >> 8, (c[1] * w) >> 8, (c[2] * w) >> 8);
+        q += q_step;
+        rem += rem_step;
+        if (rem >= num_pixels) { rem -= num_pixels; q++; }
+    }
+}
+
 void SavaLED_ESP32::rainbowStatic(uint16_t start_pixel, uint16_t num_pixels, bool reversed, uint8_t brightness, uint8_t start_hue) {
     // Эта функция просто вызывает основную, передавая ей "конечный тон" по умолчанию (255).
     // Это создаст полный спектр радуги.
@@ -420,153 +1746,175 @@ void SavaLED_ESP32::rainbowStatic(uint16_t start_pixel, uint16_t num_pixels, boo
 }
 
 void SavaLED_ESP32::rainbowStatic(uint16_t start_pixel, uint16_t num_pixels, bool reversed, uint8_t brightness, uint8_t start_hue, uint8_t end_hue) {
-    if (num_pixels == 0) return;
-
-    for (uint16_t i = 0; i < num_pixels; i++) {
-        int pixel_index;
-        if (reversed) {
-            pixel_index = start_pixel - i;
-        } else {
-            pixel_index = start_pixel + i;
-        }
-
-        if (pixel_index < 0 || pixel_index >= _numLeds) {
-            continue; 
-        }
-
-        // Линейная интерполяция Тона (Hue) от start_hue до end_hue
-        uint8_t hue = start_hue + ((int16_t)end_hue - start_hue) * i / (num_pixels > 1 ? num_pixels - 1 : 1);
-        
+    uint16_t i_begin, i_end;
+    if (!_clipSpan(start_pixel, num_pixels, reversed, i_begin, i_end)) return;
+    _markSpan(start_pixel, i_begin, i_end, reversed);
+
+    int step = reversed ? -_bpp : _bpp;
+    uint8_t* p = _pixels + (uint32_t)(reversed ? start_pixel - i_begin : start_pixel + i_begin) * _bpp;
+
+    // Линейная интерполяция Тона (Hue) от start_hue до end_hue:
+    // |end - start| * i / (n - 1) считаем приращениями частного и остатка.
+    int16_t delta = (int16_t)end_hue - start_hue;
+    uint32_t span = delta < 0 ? -delta : delta;
+    uint32_t div = num_pixels > 1 ? num_pixels - 1 : 1;
+    uint32_t q = span * i_begin / div, rem = span * i_begin % div;
+    const uint32_t q_step = span / div, rem_step = span % div;
+
+    for (uint16_t i = i_begin; i < i_end; i++, p += step) {
+        uint8_t hue = delta < 0 ? start_hue - q : start_hue + q;
         // Рисуем пиксель, используя рассчитанный тон и заданную яркость
-        setPixelHSV(pixel_index, hue, 255, brightness);
+        _writeHSV(p, hue, brightness);
+        q += q_step;
+        rem += rem_step;
+        if (rem >= div) { rem -= div; q++; }
     }
 }
 
 
 void SavaLED_ESP32::breathingRainbow(uint16_t speed, uint8_t brightness) {
-    static uint32_t last_update = 0;
-    static uint8_t counter = 0;
+    EffectState& state = _breathing_state;
     if (speed == 0) return;
-    uint32_t frame_delay = map(speed, 1, 255, 50, 1);
-    if (millis() - last_update < frame_delay) return;
-    last_update = millis();
-    counter++;
-    fillHSV(counter, 255, brightness);
+    state.phase.rate = savaSpeedToRate(speed);
+    if (!state.phase.advance(_stepDt(_frame_us, state.last_update))) return;
+    fillHSV(state.phase.step(), 255, brightness);
     //if (canShow()) show();
 }
 // --- РЕАЛИЗАЦИЯ ЭФФЕКТА "КОМЕТЫ" (ИНКАПСУЛИРОВАННАЯ ВЕРСИЯ) ---
 
 // --- Публичный метод ---
 void SavaLED_ESP32::runCometsEffect(uint8_t num_comets, uint8_t tail_length, const uint32_t palette[], int palette_size, uint32_t background_color, uint16_t spawn_interval_ms) {
-    if (num_comets > SAVA_MAX_COMETS) num_comets = SAVA_MAX_COMETS;
-
-    static unsigned long last_frame_time = 0;
-    const int FRAME_INTERVAL_MS = 1000 / 60; // 60 FPS
-
-    // 1. Логика (спаун и обновление позиций) - выполняется всегда
-    if (millis() - _comets_last_spawn_attempt >= spawn_interval_ms) {
-        _comets_last_spawn_attempt = millis();
-        _spawnComet(num_comets, tail_length, palette, palette_size);
-    }
-    _updateComets(tail_length);
-
-    // 2. Отрисовка - выполняется с фиксированным FPS
-    if (millis() - last_frame_time >= FRAME_INTERVAL_MS) {
-        last_frame_time = millis();
-        _drawComets(background_color, tail_length);
-        //if (canShow()) {
-          //  show();
-        //}
-    }
-}
-
-// --- Приватные методы (твоя логика, перенесенная внутрь класса) ---
-void SavaLED_ESP32::_spawnComet(uint8_t num_comets, uint8_t tail_length, const uint32_t palette[], int palette_size) {
-    // Ищем "спящую" комету только среди активного пула
-    for (int i = 0; i < num_comets; i++) {
-        if (_comets[i].state == CometState::INACTIVE) {
-            SavaComet& c = _comets[i];
-            c.state = CometState::APPEARING;
-            c.color = palette[random(palette_size)];
-            c.position = random(_numLeds);
-            
-            const int edgeZoneSize = _numLeds / 4;
-            if (c.position < edgeZoneSize) c.direction = 1;
-            else if (c.position >= _numLeds - edgeZoneSize) c.direction = -1;
-            else c.direction = (random(2) == 0) ? 1 : -1;
-
-            c.brightness = 0;
-            c.speed_ms = random(20, 71);
-            c.tail_length = tail_length; // Используем переданный параметр
-            c.current_tail_len = 0;
-            c.spawn_time = millis();
-            c.last_move_time = millis();
-            return;
-        }
-    }
+    _comets_effect.configure(num_comets, tail_length, palette, palette_size, background_color, spawn_interval_ms);
+
+    // Логика и отрисовка - с фиксированным FPS эффекта
+    if (_frame_us - _comets_last_frame < _comets_effect.interval_ms * 1000UL) return;
+    SavaTime t = {_frame_us, _stepDt(_frame_us, _comets_last_frame)};
+    SavaSegment all = {0, _numLeds, false};
+    _comets_effect.update(t, all);
+    _comets_effect.draw(*this, all);
 }
 
-void SavaLED_ESP32::_updateComets(uint8_t tail_length) {
-    unsigned long currentTime = millis();
-    for (int i = 0; i < SAVA_MAX_COMETS; i++) {
-        if (_comets[i].state == CometState::INACTIVE) continue;
+// Прибавляет цвет с яркостью brightness к пикселю n с насыщением
+void SavaLED_ESP32::_addPixel(uint16_t n, uint32_t color, uint8_t brightness) {
+    if (!_pixels || n >= _numLeds) return;
+    uint8_t add[4];
+    uint16_t w = savaWeight(brightness);
+    _writePixel(add, (((color >> 16) & 0xFF) * w) >> 8, (((color >> 8) & 0xFF) * w) >> 8, ((color & 0xFF) * w) >> 8);
+    savaAddSatScalar(_pixels + (uint32_t)n * _bpp, add, _bpp);
+    _markDirty(n, n + 1);
+}
 
-        SavaComet& c = _comets[i];
-        const unsigned long APPEAR_DURATION = 1800;
+// --- СТАТИСТИКА ---
+
+SavaLEDStats SavaLED_ESP32::getStats() {
+    SavaLEDStats stats = {};
+#if SAVA_ENABLE_STATS
+    uint32_t mhz = getCpuFrequencyMhz();
+    portENTER_CRITICAL(&_tx_mux);
+    SavaTimingAcc render = _stats_render, prep = _stats_prep, wire = _stats_wire, interval = _stats_interval;
+    stats.frames = _stats_frames;
+    stats.dropped_frames = _stats_dropped;
+    stats.skipped_frames = _stats_skipped;
+    portEXIT_CRITICAL(&_tx_mux);
+
+    // Отрисовка и подготовка измеряются в тактах CPU, передача и интервал - в мкс
+    stats.render = {render.min / mhz, render.avg / mhz, render.max / mhz};
+    stats.prep = {prep.min / mhz, prep.avg / mhz, prep.max / mhz};
+    stats.wire = {wire.min, wire.avg, wire.max};
+    stats.fps = interval.avg ? 1000000.0f / interval.avg : 0.0f;
+#endif
+    return stats;
+}
 
-        if (c.state == CometState::APPEARING) {
-            unsigned long timePassed = currentTime - c.spawn_time;
-            if (timePassed >= APPEAR_DURATION) {
-                c.state = CometState::MOVING;
-                c.brightness = 255;
-                c.last_move_time = currentTime;
-            } else {
-                c.brightness = map(timePassed, 0, APPEAR_DURATION, 0, 255);
-            }
-        } else if (c.state == CometState::MOVING) {
-            if (currentTime - c.last_move_time >= c.speed_ms) {
-                c.last_move_time += c.speed_ms;
-                c.position += c.direction;
-
-                if (c.current_tail_len < tail_length) {
-                    c.current_tail_len++;
-                }
-                if ((c.direction == 1 && c.position >= _numLeds + tail_length) ||
-                    (c.direction == -1 && c.position < 0 - tail_length)) {
-                    c.state = CometState::INACTIVE;
-                }
-            }
-        }
+SavaTimingHistogram SavaLED_ESP32::getTimingHistogram(SavaStatsStage stage) {
+    SavaTimingHistogram hist = {};
+#if SAVA_ENABLE_STATS
+    if (stage > SAVA_STAGE_WIRE) return hist;
+    portENTER_CRITICAL(&_tx_mux);
+    memcpy(hist.bins, _stats_hist[stage], sizeof(hist.bins));
+    portEXIT_CRITICAL(&_tx_mux);
+#endif
+    return hist;
+}
+
+void SavaLED_ESP32::resetStats() {
+#if SAVA_ENABLE_STATS
+    portENTER_CRITICAL(&_tx_mux);
+    _stats_render = _stats_prep = _stats_wire = _stats_interval = SavaTimingAcc();
+    memset(_stats_hist, 0, sizeof(_stats_hist));
+    _stats_dropped = 0;
+    _stats_skipped = 0;
+    portEXIT_CRITICAL(&_tx_mux);
+#endif
+}
+
+// --- ЗАДАЧА РЕНДЕРА ---
+
+bool SavaLED_ESP32::addRenderCallback(SavaRenderCallback callback, void* arg) {
+    if (!callback || _num_render_callbacks >= SAVA_MAX_RENDER_CALLBACKS) return false;
+    _render_callbacks[_num_render_callbacks].callback = callback;
+    _render_callbacks[_num_render_callbacks].arg = arg;
+    _num_render_callbacks++;
+    return true;
+}
+
+void SavaLED_ESP32::clearRenderCallbacks() {
+    _num_render_callbacks = 0;
+}
+
+bool SavaLED_ESP32::startRenderTask(uint16_t fps, BaseType_t core, UBaseType_t priority, uint32_t stack_size) {
+    if (!_isReady || _render_task || fps == 0) return false;
+
+    _render_period = pdMS_TO_TICKS(1000 / fps);
+    if (_render_period == 0) _render_period = 1;
+    _missed_frames = 0;
+    _render_running = true;
+
+    if (xTaskCreatePinnedToCore(_renderTaskEntry, "SavaLED", stack_size, this, priority, &_render_task, core) != pdPASS) {
+        _render_running = false;
+        _render_task = nullptr;
+        return false;
     }
+    return true;
 }
 
-void SavaLED_ESP32::_drawComets(uint32_t background_color, uint8_t tail_length) {
-    fill(background_color); // Рисуем фон
+void SavaLED_ESP32::stopRenderTask() {
+    if (!_render_task) return;
+    _render_running = false;
+    // Из самой задачи (функция отрисовки) ждать нельзя - цикл кончится после возврата
+    if (xTaskGetCurrentTaskHandle() == _render_task) return;
+    // Задача сама завершится в конце текущего кадра и обнулит _render_task
+    while (_render_task) vTaskDelay(1);
+}
 
-    for (int i = 0; i < SAVA_MAX_COMETS; i++) {
-        if (_comets[i].state != CometState::INACTIVE) {
-            SavaComet& c = _comets[i];
-            
-            // Рисуем голову
-            if (c.position >= 0 && c.position < _numLeds) {
-                setPixelColor(c.position, c.color, c.brightness);
-            }
-            
-            // Рисуем хвост
-            if (c.state == CometState::MOVING) {
-                for (int j = 0; j < c.current_tail_len; j++) {
-                    int tailPos = c.position - (c.direction * (j + 1));
-                    if (tailPos >= 0 && tailPos < _numLeds) {
-                        // Яркость хвоста убывает. Вместо TAIL_BRIGHTNESS[j] используем простую математику
-                        uint8_t tailBrightness = 255 * (c.current_tail_len - j) / c.current_tail_len;
-                        // += для смешивания цветов, если пиксели пересекаются
-                        // Для этого нужно будет сначала прочитать цвет пикселя, а потом добавить.
-                        // Для простоты пока просто рисуем поверх (setPixelColor)
-                        setPixelColor(tailPos, c.color, tailBrightness);
-                    }
-                }
+bool SavaLED_ESP32::isRenderTaskRunning() const {
+    return _render_task != nullptr;
+}
+
+uint32_t SavaLED_ESP32::getMissedFrames() const {
+    return _missed_frames;
+}
+
+void SavaLED_ESP32::_renderTaskEntry(void* arg) {
+    ((SavaLED_ESP32*)arg)->_renderLoop();
+    vTaskDelete(nullptr);
+}
+
+void SavaLED_ESP32::_renderLoop() {
+    TickType_t last_wake = xTaskGetTickCount();
+    while (_render_running) {
+        // Ждем место в конвейере не дольше одного периода, иначе кадр пропущен
+        if (waitForFrame(_render_period * portTICK_PERIOD_MS)) {
+            for (uint8_t i = 0; i < _num_render_callbacks; i++) {
+                _render_callbacks[i].callback(*this, _render_callbacks[i].arg);
             }
+            show();
+        }
+        // xTaskDelayUntil возвращает pdFALSE, если срок кадра уже прошел
+        if (xTaskDelayUntil(&last_wake, _render_period) == pdFALSE) {
+            _missed_frames++;
+            last_wake = xTaskGetTickCount(); // Не "догоняем" пропущенные кадры пачкой
         }
     }
+    _render_task = nullptr;
 }
-
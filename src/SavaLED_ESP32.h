@@ -3,12 +3,43 @@
 
 #include <Arduino.h>
 #include "driver/rmt_tx.h"
+#include "esp_idf_version.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
-// Определяем общепринятые константы для таймингов WS2812.
+#include "freertos/task.h"
+#include "SavaLED_Kernels.h"
+// Разрешение RMT: все тайминги чипов пересчитываются в тики этой частоты.
 #define RMT_LED_STRIP_RESOLUTION_HZ 10000000 // 10MHz разрешение, 1 тик = 100ns
-// --- Максимальное кол-во комет, которое поддерживает библиотека ---
-#define SAVA_MAX_COMETS 10
+// --- Простой RMT-энкодер (rmt_new_simple_encoder) появился в ESP-IDF 5.3 ---
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+#define SAVA_HAS_SIMPLE_ENCODER 1
+#else
+#define SAVA_HAS_SIMPLE_ENCODER 0
+#endif
+// --- Максимальное кол-во выходов (RMT-каналов) на один объект ---
+#define SAVA_MAX_OUTPUTS 8
+// --- Максимальная глубина конвейера кадров ---
+#define SAVA_MAX_PIPELINE 4
+// --- Сбор статистики кадров (getStats()). 0 - полностью отключить ---
+#ifndef SAVA_ENABLE_STATS
+#define SAVA_ENABLE_STATS 1
+#endif
+// --- Кол-во корзин гистограммы времени этапа кадра (getTimingHistogram()) ---
+#define SAVA_STATS_BINS 16
+// --- Максимальное кол-во функций отрисовки для задачи рендера ---
+#define SAVA_MAX_RENDER_CALLBACKS 8
+// --- Максимальное кол-во слоев композитора ---
+#define SAVA_MAX_LAYERS 4
+// --- Максимальное кол-во эффектов в планировщике (и эффектов rainbowCycle() за кадр) ---
+#define SAVA_MAX_EFFECTS 16
+// --- Максимальное кол-во одновременных переходов между эффектами (2 буфера размером с ленту на каждый) ---
+#define SAVA_MAX_TRANSITIONS 2
+// --- Максимальное кол-во сегментов вывода (своя яркость/гамма/баланс белого) ---
+#define SAVA_MAX_SEGMENTS 8
+// --- Показатель гамма-кривой по умолчанию (яркость канала = код^gamma) ---
+#define SAVA_DEFAULT_GAMMA 2.3f
+// --- Максимальный шаг часов анимации: после паузы анимация не "перепрыгивает" дальше ---
+#define SAVA_MAX_STEP_US 1000000
 // --- Предопределенные цветовые константы (формат 0xRRGGBB) ---
 const uint32_t RED      = 0xFF0000;
 const uint32_t LIME     = 0x00FF00; // Ярко-зеленый
@@ -40,21 +71,149 @@ const uint32_t WHITE    = 0xFFFFFF;
 const uint32_t SILVER   = 0xC0C0C0;
 const uint32_t GRAY     = 0x808080;
 const uint32_t BLACK    = 0x000000; // Он же "Выключено"
-// Состояние кометы
-enum class CometState { INACTIVE, APPEARING, MOVING };
-// Структура для хранения данных одной кометы
-struct SavaComet {
-    CometState    state = CometState::INACTIVE;
-    uint32_t      color = 0;
-    int           position = 0;
-    int           direction = 1;
-    uint8_t       brightness = 0;
-    long          speed_ms = 50;
-	int           tail_length = 10;
-    int           current_tail_len = 0;
-    unsigned long spawn_time = 0;
-    unsigned long last_move_time = 0;
+// Формат пикселя в буфере: смещение каждого канала внутри пикселя и байт на пиксель.
+// Порядок каналов задается один раз при begin(), запись пикселя - прямые записи по смещениям.
+// Для 3-байтных форматов смещение W совпадает с R (запись W сразу перезаписывается).
+struct SavaPixelFormat {
+    uint8_t r, g, b, w;
+    uint8_t bpp;
 };
+constexpr SavaPixelFormat SAVA_GRB  = {1, 0, 2, 1, 3}; // WS2812B (по умолчанию)
+constexpr SavaPixelFormat SAVA_RGB  = {0, 1, 2, 0, 3}; // WS2811 и часть клонов
+constexpr SavaPixelFormat SAVA_BRG  = {1, 2, 0, 1, 3};
+constexpr SavaPixelFormat SAVA_RBG  = {0, 2, 1, 0, 3};
+constexpr SavaPixelFormat SAVA_GBR  = {2, 0, 1, 2, 3};
+constexpr SavaPixelFormat SAVA_BGR  = {2, 1, 0, 2, 3};
+constexpr SavaPixelFormat SAVA_GRBW = {1, 0, 2, 3, 4}; // SK6812 RGBW
+constexpr SavaPixelFormat SAVA_RGBW = {0, 1, 2, 3, 4};
+
+// Тайминги чипа, в наносекундах (биты) и микросекундах (сброс/защелка)
+struct SavaChipTiming {
+    uint16_t t0h_ns, t0l_ns;
+    uint16_t t1h_ns, t1l_ns;
+    uint16_t reset_us;
+};
+constexpr SavaChipTiming SAVA_WS2812B = {400, 850, 800, 450, 280};
+constexpr SavaChipTiming SAVA_SK6812  = {300, 900, 600, 600, 80};
+constexpr SavaChipTiming SAVA_WS2811  = {500, 2000, 1200, 1300, 280};
+constexpr SavaChipTiming SAVA_WS2815  = {300, 1090, 1090, 320, 280};
+
+// Настройки RMT-передачи, передаются в begin()/beginMulti()
+struct SavaLEDConfig {
+    bool               with_dma = false;                // Передача через DMA (ESP32-S3 и новее): меньше прерываний
+    size_t             mem_block_symbols = 64;          // Размер памяти символов канала (с DMA - размер DMA-буфера)
+    size_t             trans_queue_depth = 4;           // Глубина очереди передач драйвера
+    int                intr_priority = 0;               // Приоритет прерывания RMT (0 - выбор драйвера)
+    rmt_clock_source_t clk_src = RMT_CLK_SRC_DEFAULT;   // Источник тактирования RMT
+    uint8_t            pipeline_depth = 1;              // Кадров в очереди на отправку (1..SAVA_MAX_PIPELINE)
+    SavaPixelFormat    format = SAVA_GRB;               // Порядок каналов и байт на пиксель
+    SavaChipTiming     timing = SAVA_WS2812B;           // Тайминги чипа
+};
+
+// Минимум / среднее / максимум одного измерения, в микросекундах
+struct SavaTiming {
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t max_us;
+};
+
+// Статистика кадров, возвращается getStats()
+struct SavaLEDStats {
+    SavaTiming render;          // Отрисовка кадра приложением (от конца show() до следующего show())
+    SavaTiming prep;            // Подготовка кадра в show() (яркость/гамма, копирование)
+    SavaTiming wire;            // Передача кадра по RMT
+    float      fps;             // Фактическая частота отправленных кадров
+    uint32_t   frames;          // Всего отправлено кадров
+    uint32_t   dropped_frames;  // Вызовы show(), отброшенные из-за !canShow()
+    uint32_t   skipped_frames;  // Неизменившиеся кадры, не переданные из-за setSkipUnchanged()
+};
+
+// Этап кадра для getTimingHistogram()
+enum SavaStatsStage : uint8_t {
+    SAVA_STAGE_RENDER,
+    SAVA_STAGE_PREP,
+    SAVA_STAGE_WIRE
+};
+
+// Распределение времени этапа по степеням двойки: корзина 0 - меньше 2 мкс, корзина k -
+// от 2^k до 2^(k+1) мкс, в последнюю попадает все от 2^(SAVA_STATS_BINS-1) мкс (~33 мс)
+struct SavaTimingHistogram {
+    uint32_t bins[SAVA_STATS_BINS];
+};
+
+// Модель потребления ленты для ограничения мощности (setMaxPowerMilliwatts())
+struct SavaPowerModel {
+    uint16_t millivolts = 5000;     // Напряжение питания ленты
+    uint8_t  channel_ma = 20;       // Ток одного канала (R, G, B или W) на полной яркости
+    uint16_t idle_ua = 1000;        // Ток погашенного светодиода (сама микросхема), мкА
+};
+
+// Кривая гамма-коррекции: код цвета 0..255 -> яркость канала 0..255 по закону x^gamma
+struct SavaGammaCurve {
+    float   gamma;
+    uint8_t table[256];
+};
+
+// Профиль ленты: кривая и коррекция цвета - множители каналов 0..255 после гаммы.
+// Светодиоды разных партий отличаются яркостью кристаллов, коррекция выравнивает белый.
+struct SavaColorProfile {
+    SavaGammaCurve curve;
+    uint8_t r, g, b, w;
+};
+
+// --- Генерация кривых на этапе компиляции ---
+// powf() компилятор не вычисляет, поэтому log/exp - свои, на рядах. Профиль, объявленный
+// constexpr, ложится во флеш готовой таблицей: ни расчета при старте, ни кода расчета.
+constexpr double savaLnConst(double x) {
+    // x = m * 2^k, m в [1, 2): ln(m) = 2 * atanh((m - 1) / (m + 1)), ряд по нечетным степеням
+    int k = 0;
+    while (x >= 2.0) { x *= 0.5; k++; }
+    while (x < 1.0) { x *= 2.0; k--; }
+    double z = (x - 1.0) / (x + 1.0), z2 = z * z, term = z, sum = 0.0;
+    for (int n = 1; n < 40; n += 2) { sum += term / n; term *= z2; }
+    return 2.0 * sum + k * 0.69314718055994531;
+}
+constexpr double savaExpConst(double y) {
+    // y = k * ln2 + r, |r| <= ln2 / 2: e^r рядом Тейлора, затем умножение на 2^k
+    int k = (int)(y / 0.69314718055994531 + (y < 0 ? -0.5 : 0.5));
+    double r = y - k * 0.69314718055994531, term = 1.0, sum = 1.0;
+    for (int n = 1; n < 20; n++) { term *= r / n; sum += term; }
+    for (; k > 0; k--) sum *= 2.0;
+    for (; k < 0; k++) sum *= 0.5;
+    return sum;
+}
+constexpr SavaGammaCurve savaGammaCurve(float gamma) {
+    SavaGammaCurve c = {gamma, {}};
+    for (int i = 1; i < 256; i++) c.table[i] = (uint8_t)(savaExpConst(gamma * savaLnConst(i / 255.0)) * 255.0 + 0.5);
+    return c;
+}
+constexpr SavaColorProfile savaColorProfile(float gamma, uint8_t r = 255, uint8_t g = 255, uint8_t b = 255, uint8_t w = 255) {
+    return {savaGammaCurve(gamma), r, g, b, w};
+}
+// Типичные профили: у лент 5050 (WS2812B, SK6812) зеленый и синий ярче красного,
+// у гирлянд из пикселей WS2811 белый уходит в синеву
+constexpr SavaColorProfile SAVA_PROFILE_WS2812B = savaColorProfile(SAVA_DEFAULT_GAMMA, 255, 176, 240);
+constexpr SavaColorProfile SAVA_PROFILE_WS2811  = savaColorProfile(SAVA_DEFAULT_GAMMA, 255, 224, 140);
+
+// Режим наложения слоя на слои под ним.
+// Альфа-канала у пикселей слоя нет: прозрачность SAVA_BLEND_KEYED задается цветовым ключом
+// (черный), непрозрачность одна на весь слой. Черный цвет таким слоем не нарисовать, а
+// плавные края получаются только затемнением к черному - его видно как обычный цвет, пока
+// пиксель не станет черным целиком.
+enum SavaBlendMode : uint8_t {
+    SAVA_BLEND_KEYED,       // Поверх с непрозрачностью слоя, черные пиксели слоя прозрачны
+    SAVA_BLEND_ADD,         // Сложение с насыщением
+    SAVA_BLEND_MAX,         // Максимум по каждому каналу
+    SAVA_BLEND_MULTIPLY,    // Умножение (затемнение, маска)
+    SAVA_BLEND_SCREEN       // "Экран" (осветление без пересвета)
+};
+
+class SavaLED_ESP32;
+// Функция отрисовки кадра, вызывается задачей рендера перед каждым show()
+typedef void (*SavaRenderCallback)(SavaLED_ESP32& strip, void* arg);
+
+#include "SavaLED_Palette.h"
+#include "SavaLED_Effects.h"
 
 /**
  * @class SavaLED_ESP32
@@ -67,9 +226,29 @@ public:
     ~SavaLED_ESP32();
 
     // --- Основные функции ---
-    bool begin(uint16_t numLeds, int pin);    // Инициализация
+    bool begin(uint16_t numLeds, int pin, const SavaLEDConfig& config = SavaLEDConfig());    // Инициализация
+    /**
+    * @brief Инициализация с несколькими выходами: один логический буфер делится на сегменты,
+    *        каждый сегмент передается своим RMT-каналом одновременно с остальными.
+    *        Индексация пикселей сквозная: выход 0 - пиксели [0, counts[0]), выход 1 - следующие и т.д.
+    * @param numOutputs Количество выходов (1..SAVA_MAX_OUTPUTS, не больше RMT TX каналов чипа).
+    * @param pins Массив пинов для каждого выхода.
+    * @param counts Массив количества светодиодов на каждом выходе.
+    * @param config Настройки RMT (DMA, память символов, очередь, прерывание, тактирование).
+    */
+    bool beginMulti(uint8_t numOutputs, const int pins[], const uint16_t counts[], const SavaLEDConfig& config = SavaLEDConfig());
     void show();                              // Отправка данных на ленту
     bool canShow() const;                       // Проверка готовности к следующему кадру    
+    /**
+    * @brief Блокирующее ожидание свободного места для кадра (без опроса canShow() в цикле).
+    *        Задача спит, пока RMT не закончит передачу очередного кадра.
+    * @param timeout_ms Максимальное время ожидания в мс.
+    * @return true, если можно рисовать и вызывать show().
+    */
+    bool waitForFrame(uint32_t timeout_ms = 1000);
+    SavaLEDStats getStats();                    // Статистика кадров (нужен SAVA_ENABLE_STATS)
+    SavaTimingHistogram getTimingHistogram(SavaStatsStage stage);   // Распределение времени этапа
+    void resetStats();
     void setBrightness(uint8_t brightness);
     uint16_t getNumLeds() const;
     
@@ -82,13 +261,195 @@ public:
     void fill(uint32_t color);
     void fillColor(uint32_t color, uint8_t brightness);
 
+    // --- RGBW (SK6812): формат SAVA_GRBW / SAVA_RGBW ---
+    void setPixelRGBW(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w); // Каналы задаются напрямую
+    /**
+    * @brief Выделение белого для RGB-цветов на RGBW-ленте: общая часть min(r,g,b)
+    *        переносится в канал W. Включено по умолчанию для 4-байтных форматов.
+    */
+    void setWhiteExtraction(bool enabled);
+
+    // --- Пакетная запись диапазонов (границы проверяются один раз) ---
+    /**
+    * @brief Заливает диапазон пикселей одним цветом. Диапазон обрезается по длине ленты.
+    * @param start Индекс первого пикселя.
+    * @param count Количество пикселей.
+    * @param color Цвет в формате 0xRRGGBB.
+    */
+    void fillRange(uint16_t start, uint16_t count, uint32_t color);
+    /**
+    * @brief Копирует массив цветов 0xRRGGBB в ленту, начиная с пикселя start.
+    */
+    void writePixels(uint16_t start, const uint32_t* colors, uint16_t count);
+    /**
+    * @brief Копирует "сырые" байты в порядке ленты (формат из SavaLEDConfig::format) без преобразований.
+    */
+    void writeRaw(uint16_t start, const uint8_t* data, uint16_t count);
+
+    // --- Преобразования всего буфера (векторные ядра SavaLED_Kernels.h) ---
+    void scalePixels(uint8_t scale);                    // Умножает все каналы на scale/256
+    void fadeToBlack(uint8_t amount);                   // Затухание к черному: 0 - без изменений, 255 - черный
+    void addColor(uint32_t color);                      // Прибавляет цвет ко всем пикселям с насыщением
+    void blendColor(uint32_t color, uint8_t amount);    // Смешивает все пиксели с цветом: 0 - без изменений, 255 - цвет
+
     // --- Функции-помощники и работа с цветом (HSV) ---
     uint32_t Color(uint8_t r, uint8_t g, uint8_t b);
+    uint32_t ColorHSV(uint8_t h, uint8_t s = 255, uint8_t v = 255);
     void setPixelHSV(uint16_t n, uint8_t h, uint8_t s, uint8_t v);
     void fillHSV(uint8_t h, uint8_t s, uint8_t v);
 
     // --- Гамма-коррекция ---
     void setGammaCorrection(bool enabled);
+    /**
+    * @brief Кривая гаммы x^gamma, считается при вызове (256 powf), повторный вызов
+    *        с тем же показателем ничего не пересчитывает. Кривая, яркость, коррекция цвета
+    *        и ограничитель мощности сводятся в одну таблицу - show() не делает лишней работы.
+    * @param gamma Показатель: 1.0 - линейно, 2.2..2.8 - типичные ленты (по умолчанию SAVA_DEFAULT_GAMMA).
+    */
+    void setGamma(float gamma);
+    float getGamma() const { return _curve.gamma; }
+    // Коррекция цвета ленты: множители каналов 0..255 после гаммы (255 - без изменений)
+    void setColorCorrection(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 255);
+    /**
+    * @brief Кривая и коррекция из профиля, например constexpr savaColorProfile() или
+    *        SAVA_PROFILE_WS2812B: таблица уже готова, копируется без расчета.
+    */
+    void setColorProfile(const SavaColorProfile& profile);
+
+    // --- Сегменты вывода: своя яркость, гамма и баланс белого на участке ленты ---
+    /**
+    * @brief Создает сегмент вывода [start, start + count). Настройки сегмента вместе с общими
+    *        яркостью, гаммой и ограничителем мощности сводятся в таблицы на каждый канал,
+    *        которые применяются в том же проходе show(), что и общая таблица, - без
+    *        дополнительных проходов по буферу. Рисовать можно полными 0..255 в любом сегменте.
+    *        Сегменты не пересекаются. Не применяются в режиме setEncoderCorrection(true).
+    * @param name Имя для findSegment() (строка не копируется).
+    * @return Номер сегмента или -1 (пересечение, нет места/памяти, или begin() не вызван).
+    */
+    int8_t addSegment(uint16_t start, uint16_t count, const char* name = nullptr);
+    int8_t findSegment(const char* name) const;
+    void removeSegments();
+    void setSegmentBrightness(int8_t id, uint8_t brightness);   // 0..255, поверх setBrightness()
+    void setSegmentGamma(int8_t id, bool enabled);
+    // Баланс белого: множители каналов 0..255 (255 - без изменений)
+    void setSegmentWhiteBalance(int8_t id, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 255);
+
+    // --- Двойная буферизация ---
+    /**
+    * @brief Включает режим двойной буферизации без копирования кадра.
+    *        show() применяет яркость/гамму прямо в буфере рисования и меняет его местами
+    *        с буфером отправки. После show() содержимое буфера рисования не определено,
+    *        поэтому каждый кадр нужно рисовать целиком (clear()/fill() + эффекты).
+    * @param enabled true - включить, false - обычный режим с копированием (по умолчанию).
+    */
+    void setDoubleBuffer(bool enabled);
+    /**
+    * @brief Пропуск неизменившихся кадров: show() ничего не передает, если с прошлой
+    *        передачи не было рисования (и не менялись яркость/гамма).
+    *        Независимо от этого show() готовит только измененный диапазон пикселей.
+    *        В режимах обмена буферов (setDoubleBuffer(), setEncoderCorrection() с конвейером)
+    *        кадр считается неизменным, если не было рисования, а повтор передает последний
+    *        отправленный кадр как есть: новые яркость/гамма (при двойном буфере) и дизеринг
+    *        применяются со следующего нарисованного кадра.
+    * @param enabled true - пропускать, false - передавать каждый кадр (по умолчанию).
+    * @param keepalive_ms Период принудительной передачи неизменного кадра (0 - не передавать).
+    */
+    void setSkipUnchanged(bool enabled, uint32_t keepalive_ms = 1000);
+    bool hasChanges() const;    // Было ли рисование с момента последней передачи
+    /**
+    * @brief Временной дизеринг: яркость и гамма считаются с точностью 8.8 бит, а дробная
+    *        часть каждого канала переносится в следующий кадр (накопление ошибки).
+    *        В среднем по времени канал получает промежуточные уровни, поэтому на низкой
+    *        яркости исчезают ступеньки затухания и не пропадают темные цвета.
+    *        Требует частой передачи кадров (show() в каждом кадре, чем чаще - тем лучше):
+    *        кадры готовятся целиком и не пропускаются setSkipUnchanged().
+    *        Выделяет буфер остатков (байт на канал). Не работает с setEncoderCorrection().
+    * @return false, если не хватило памяти.
+    */
+    bool setDithering(bool enabled);
+
+    // --- Ограничение мощности ---
+    void setPowerModel(const SavaPowerModel& model);
+    /**
+    * @brief Ограничивает потребление ленты. show() оценивает мощность кадра в том же
+    *        проходе, которым готовит буфер отправки, и при превышении бюджета приглушает
+    *        следующие кадры (общий множитель в таблице яркости, задержка - один кадр).
+    *        В режиме setEncoderCorrection() прохода нет, оценка делается отдельным проходом.
+    * @param max_mw Бюджет в мВт (0 - без ограничения).
+    */
+    void setMaxPowerMilliwatts(uint32_t max_mw);
+    uint32_t getPowerMilliwatts() const;    // Оценка мощности последнего переданного кадра, мВт
+    uint16_t getPowerScale() const;         // Текущий множитель ограничителя, 0..256 (256 - не ограничено)
+    /**
+    * @brief Возвращает указатель на текущий буфер рисования (порядок и число байт на пиксель - из SavaLEDConfig::format).
+    *        В режиме двойной буферизации указатель меняется после каждого show().
+    */
+    uint8_t* getPixels();
+
+    /**
+    * @brief Включает коррекцию яркости/гаммы прямо в RMT-энкодере во время передачи.
+    *        Буфер отправки не выделяется (экономия RAM в 2 раза), show() не делает
+    *        проход по буферу. Вызывать ДО begin(). Пока !canShow(), буфер пикселей
+    *        читается энкодером - рисуйте новый кадр только после canShow().
+    *        При pipeline_depth > 1 буферы вращаются как в setDoubleBuffer(true).
+    *        Энкодер читает одну из двух копий таблиц коррекции (+2 КБ), новые яркость/гамма
+    *        вступают в силу с начала кадра, а не посреди передачи.
+    *        Требует ESP-IDF 5.3+, на более старых версиях игнорируется.
+    * @param enabled true - коррекция в энкодере, false - обычный режим (по умолчанию).
+    */
+    void setEncoderCorrection(bool enabled);
+
+    // --- Слои (композитор) ---
+    /**
+    * @brief Создает слой размером с ленту. Слои накладываются по порядку создания
+    *        в show() одним проходом; перекомпонуется только измененный диапазон пикселей.
+    *        При наличии слоев основной буфер - результат наложения, рисовать нужно в слои.
+    * @return Номер слоя или -1 (нет места/памяти, или begin() не вызван).
+    */
+    int8_t addLayer(SavaBlendMode mode = SAVA_BLEND_KEYED, uint8_t opacity = 255);
+    void removeLayers();
+    /**
+    * @brief Направляет все функции рисования в слой id (-1 - основной буфер).
+    *        show() возвращает рисование в основной буфер, поэтому вызывайте в каждом кадре.
+    */
+    bool drawToLayer(int8_t id);
+    void setLayerMode(int8_t id, SavaBlendMode mode);
+    void setLayerOpacity(int8_t id, uint8_t opacity);
+    void setLayerVisible(int8_t id, bool visible);
+    uint8_t getNumLayers() const;
+
+    // --- Эффекты-объекты и планировщик (SavaLED_Effects.h) ---
+    /**
+    * @brief Регистрирует эффект на отрезке ленты. Лента хранит только ссылку:
+    *        объект эффекта должен жить, пока он зарегистрирован.
+    * @param layer Слой для отрисовки (-1 - основной буфер).
+    * @return Номер эффекта или -1, если все SAVA_MAX_EFFECTS мест заняты.
+    */
+    int8_t addEffect(SavaEffect& effect, uint16_t start, uint16_t count, bool reversed = false, int8_t layer = -1);
+    void removeEffect(int8_t id);
+    void clearEffects();
+    /**
+    * @brief Планировщик: делает шаг каждого эффекта, у которого истек его interval_ms,
+    *        и перерисовывает только изменившиеся эффекты. Вызывайте в каждом кадре перед show().
+    *        Перекрывающиеся эффекты размещайте в разных слоях.
+    */
+    void runEffects();
+    /**
+    * @brief Плавная смена эффекта id на next за duration_ms по часам кадра. Оба эффекта
+    *        идут и рисуются каждый в свой буфер, результат смешивается в буфер места (слой)
+    *        одним проходом. Буферы выделяются при первом переходе и дальше переиспользуются.
+    * @return false, если свободного перехода (SAVA_MAX_TRANSITIONS) или памяти нет:
+    *         тогда эффект сменяется мгновенно.
+    */
+    bool transitionEffect(int8_t id, SavaEffect& next, SavaTransition type = SAVA_TRANSITION_FADE, uint16_t duration_ms = 1000);
+    bool isTransitioning(int8_t id) const;
+    /**
+    * @brief Часы кадра: micros(), засеченное один раз в show() для всего следующего кадра,
+    *        и время между двумя последними кадрами (не больше SAVA_MAX_STEP_US).
+    *        Используйте вместо millis()/micros() в эффектах, чтобы все эффекты кадра видели одно время.
+    */
+    uint32_t frameMicros() const { return _frame_us; }
+    uint32_t frameDelta() const { return _frame_dt_us; }
 
     // --- Неблокирующие эффекты ---
     /**
@@ -129,12 +490,19 @@ public:
     */
     void rainbowStatic(uint16_t start_pixel, uint16_t num_pixels, bool reversed, uint8_t brightness, uint8_t start_color, uint8_t end_color);
 
+    /**
+    * @brief Растягивает палитру (индексы 0..255) на сегмент ленты, как rainbowStatic() радугу.
+    * @param offset Сдвиг индекса палитры: меняя его от кадра к кадру, получаем бегущую палитру.
+    */
+    void fillPalette(uint16_t start_pixel, uint16_t num_pixels, const SavaPalette& palette, bool reversed = false,
+                     uint8_t brightness = 255, uint8_t offset = 0);
+
 
     // --- НОВАЯ ФУНКЦИЯ ДЛЯ ЭФФЕКТА КОМЕТ ---
     /**
      * @brief Запускает и обновляет неблокирующий эффект "Кометы".
      *        Вызывайте эту функцию в каждой итерации loop().
-     * @param num_comets Количество комет (до SAVA_MAX_COMETS).
+     * @param num_comets Количество комет.
      * @param tail_length Фиксированная длина хвоста для всех комет.
      * @param palette Массив цветов для случайного выбора.
      * @param palette_size Размер массива palette.
@@ -143,46 +511,290 @@ public:
      */
     void runCometsEffect(uint8_t num_comets, uint8_t tail_length, const uint32_t palette[], int palette_size, uint32_t background_color = BLACK, uint16_t spawn_interval_ms = 1500);
 
+    // --- Задача рендера (FreeRTOS) ---
+    /**
+     * @brief Регистрирует функцию отрисовки. Функции вызываются по порядку в каждом кадре.
+     * @return false, если все SAVA_MAX_RENDER_CALLBACKS мест заняты.
+     */
+    bool addRenderCallback(SavaRenderCallback callback, void* arg = nullptr);
+    void clearRenderCallbacks();
+    /**
+     * @brief Запускает отдельную задачу, которая с частотой fps вызывает функции отрисовки и show().
+     *        Пока задача работает, не рисуйте и не вызывайте show() из loop().
+     * @param fps Целевая частота кадров (период округляется до тика FreeRTOS).
+     * @param core Ядро для задачи (loop() в Arduino работает на ядре 1), tskNO_AFFINITY - любое.
+     * @param priority Приоритет задачи.
+     * @param stack_size Размер стека задачи в байтах.
+     */
+    bool startRenderTask(uint16_t fps, BaseType_t core = 0, UBaseType_t priority = 5, uint32_t stack_size = 4096);
+    /**
+     * @brief Останавливает задачу рендера и ждет конца текущего кадра.
+     *        Из функции отрисовки (внутри самой задачи) только просит задачу завершиться и
+     *        возвращается сразу: задача закончит кадр и удалит себя после возврата.
+     */
+    void stopRenderTask();
+    bool isRenderTaskRunning() const;
+    uint32_t getMissedFrames() const;       // Сколько раз задача рендера не уложилась в период кадра
+
 private:
     uint16_t _numLeds;
-    int _pin;
     uint8_t _brightness;
     bool _isReady;
     
     uint8_t* _pixels;
-    uint8_t* _tx_buffer;
+    uint8_t* _tx_frames[SAVA_MAX_PIPELINE] = {};   // Кольцо буферов отправки
+    uint8_t  _pipeline_depth;
+    uint8_t  _tx_head;
 
-    rmt_channel_handle_t _ledChannel;
-    rmt_encoder_handle_t _ledEncoder;
+    // --- Выход: один RMT-канал, отвечающий за свой сегмент общего буфера ---
+    struct SavaOutput {
+        rmt_channel_handle_t channel = nullptr;
+        rmt_encoder_handle_t encoder = nullptr;
+        SavaLED_ESP32*       owner = nullptr;
+        int                  pin = -1;
+        uint16_t             start = 0;
+        uint16_t             count = 0;
+        volatile uint32_t    done = 0;  // Сколько кадров этот выход уже отправил
+        const uint8_t (*lut)[256] = nullptr; // Коррекция в энкодере: таблица текущего кадра
+        bool                 lut_mono = true;
+    };
+    SavaOutput _outputs[SAVA_MAX_OUTPUTS];
+    uint8_t _numOutputs;
+    volatile uint32_t _frames_done;     // Сколько кадров отправили ВСЕ выходы
+    portMUX_TYPE _tx_mux;
+    SavaLEDConfig _config;
     rmt_transmit_config_t _txConfig;
 
+    bool _beginOutput(SavaOutput& out);
+    void _transmit(const uint8_t* frame);
+    IRAM_ATTR bool _outputDone(SavaOutput* out);
+
     static IRAM_ATTR bool _rmt_tx_done_callback(rmt_channel_handle_t tx_chan, const rmt_tx_done_event_data_t *edata, void *user_ctx);
+    static IRAM_ATTR size_t _rmt_encode_callback(const void *data, size_t data_size, size_t symbols_written, size_t symbols_free, rmt_symbol_word_t *symbols, bool *done, void *arg);
     SemaphoreHandle_t _tx_done_sem;
     
     void _cleanup();
+    uint8_t* _allocBuffer(size_t size);
+
+    // --- Запись пикселей без проверок: вызывающий уже обрезал диапазон ---
+    // Без ветвлений: для RGB-форматов _white_mask = 0, w = 0, а запись W перезаписывается записью R.
+    inline void _writePixel(uint8_t* p, uint8_t r, uint8_t g, uint8_t b) const {
+        uint8_t w = r < g ? r : g;
+        w = (w < b ? w : b) & _white_mask;
+        p[_fmt.w] = w;
+        p[_fmt.r] = r - w;
+        p[_fmt.g] = g - w;
+        p[_fmt.b] = b - w;
+    }
+    // Цвет радуги с тоном h и яркостью v (насыщенность 255), как в setPixelHSV()
+    inline void _writeHSV(uint8_t* p, uint8_t h, uint8_t v) {
+        uint8_t r = _rainbow_wheel[0][h];
+        uint8_t g = _rainbow_wheel[1][h];
+        uint8_t b = _rainbow_wheel[2][h];
+        if (v != 255) {
+            r = ((uint16_t)r * v) >> 8;
+            g = ((uint16_t)g * v) >> 8;
+            b = ((uint16_t)b * v) >> 8;
+        }
+        _writePixel(p, r, g, b);
+    }
+    // --- Измененный диапазон текущего буфера рисования [_dirty_lo, _dirty_hi) ---
+    inline void _markDirty(uint16_t lo, uint16_t hi) {
+        if (lo < _dirty_lo) _dirty_lo = lo;
+        if (hi > _dirty_hi) _dirty_hi = hi;
+    }
+    inline void _markAllDirty() { _dirty_lo = 0; _dirty_hi = _numLeds; }
+    void _markSpan(uint16_t start, uint16_t i_begin, uint16_t i_end, bool reversed);
+    void _addPixel(uint16_t n, uint32_t color, uint8_t brightness);
+    bool _clipRange(uint16_t start, uint16_t& count) const;
+    bool _clipSpan(uint16_t start, uint16_t num, bool reversed, uint16_t& i_begin, uint16_t& i_end) const;
+    void _fillRange(uint16_t start, uint16_t count, uint8_t r, uint8_t g, uint8_t b);
+    void _colorPattern(uint8_t pattern[12], uint32_t color) const;
+
+    // --- Слои ---
+    struct SavaLayer {
+        uint8_t*      pixels;
+        SavaBlendMode mode;
+        uint8_t       opacity;
+        bool          visible;
+        uint16_t      dirty_lo, dirty_hi;
+    };
+    SavaLayer _layers[SAVA_MAX_LAYERS] = {};
+    uint8_t   _num_layers;
+    int8_t    _active_layer;           // Куда рисуют функции рисования: -1 - основной буфер
+    uint8_t*  _main_pixels;            // Основной буфер, пока рисование идет в слой
+    uint16_t  _main_dirty_lo, _main_dirty_hi;
+    uint16_t  _dirty_lo, _dirty_hi;
+    void _composite();
+
+    // --- Пропуск неизменившихся кадров и частичная подготовка ---
+    bool      _refresh_all;                          // Передать и подготовить кадр целиком
+    bool      _skip_unchanged;
+    uint32_t  _keepalive_ms;
+    uint32_t  _last_tx_us;
+    uint16_t  _slot_dirty_lo[SAVA_MAX_PIPELINE];     // Изменения с последней подготовки слота
+    uint16_t  _slot_dirty_hi[SAVA_MAX_PIPELINE];
+
+    // --- Задача рендера ---
+    struct RenderCallback {
+        SavaRenderCallback callback;
+        void*              arg;
+    };
+    RenderCallback _render_callbacks[SAVA_MAX_RENDER_CALLBACKS];
+    uint8_t _num_render_callbacks;
+    TaskHandle_t _render_task;
+    volatile bool _render_running;
+    TickType_t _render_period;
+    volatile uint32_t _missed_frames;
+    static void _renderTaskEntry(void* arg);
+    void _renderLoop();
+
+#if SAVA_ENABLE_STATS
+    // --- Статистика: отрисовка/подготовка в тактах CPU, передача/интервал в мкс ---
+    struct SavaTimingAcc {
+        uint32_t min = 0;
+        uint32_t avg = 0;
+        uint32_t max = 0;
+        uint32_t count = 0;
+    };
+    SavaTimingAcc _stats_render, _stats_prep, _stats_wire, _stats_interval;
+    uint32_t _stats_hist[SAVA_STAGE_WIRE + 1][SAVA_STATS_BINS] = {};
+    uint32_t _stats_frames = 0;
+    uint32_t _stats_dropped = 0;
+    uint32_t _stats_skipped = 0;
+    uint32_t _stats_show_exit = 0;
+    int64_t  _stats_submit_us[SAVA_MAX_PIPELINE] = {};
+    int64_t  _stats_last_done_us = 0;
+    static IRAM_ATTR void _timingAdd(SavaTimingAcc& acc, uint32_t value);
+    static IRAM_ATTR void _histAdd(uint32_t* bins, uint32_t us);
+    void _statsFrameSubmitted(uint32_t t_enter);
+#endif
     
     // --- Таблица-ускоритель для HSV -> RGB конвертации ---
     static const uint8_t _rainbow_wheel[3][256];
     
     // --- Члены для Гамма-коррекции ---
     bool _gamma_enabled;
-    static const uint8_t _gamma_table[256];
+    SavaGammaCurve _curve;
+    uint8_t _correction[4];         // Коррекция цвета R, G, B, W
 
-	// --- ВНУТРЕННИЙ МЕНЕДЖЕР ЭФФЕКТА "КОМЕТЫ" ---
-    SavaComet _comets[SAVA_MAX_COMETS];
-    unsigned long _comets_last_spawn_attempt = 0;
+    // --- Общие таблицы яркость+гамма+коррекция, пересчитываются только при изменении настроек ---
+    uint8_t _lut[4][256];           // По положению байта в пикселе; при _lut_mono - только [0]
+    bool _lut_mono;                 // Коррекция одинакова для всех каналов - одна таблица
+    bool _lut_identity;
+    void _rebuildLut();
+    bool _channelWeights(const uint8_t* balance, uint16_t weight[4]) const;
+    void _fillLut(uint8_t* lut, uint16_t* lut16, uint8_t channels, uint8_t bright, bool gamma, const uint16_t* weight);
 
-    // Приватные методы, которые реализуют логику
-    void _spawnComet(uint8_t num_comets, uint8_t tail_length, const uint32_t palette[], int palette_size);
-    void _updateComets(uint8_t tail_length);
-    void _drawComets(uint32_t background_color, uint8_t tail_length);
-	
-    // --- Система слотов для управления состоянием встроенных эффектов ---
+    // --- Временной дизеринг ---
+    bool      _dither;
+    uint8_t*  _dither_err;          // Дробная часть (остаток) каждого канала, переносится между кадрами
+    uint16_t* _lut16;               // То же, что _lut, в формате 8.8 ([4][256], есть при дизеринге)
+    uint16_t* _curve16;             // Кривая гаммы в 8.8, пересчитывается при смене показателя
+    float     _curve16_gamma;
+    void _ditherRange(uint8_t* dst, const uint8_t* src, uint32_t from, uint32_t to);
+
+    // --- Сегменты вывода ---
+    struct OutputSegment {
+        uint16_t    start, count;
+        const char* name;
+        uint8_t     brightness;
+        bool        gamma;
+        uint8_t     balance[4];     // Множители R, G, B, W
+        uint8_t*    lut;            // [_bpp][256]: таблица байта по его положению в пикселе
+        uint16_t*   lut16;          // То же в 8.8 для дизеринга (есть, пока включен setDithering())
+    };
+    OutputSegment _segments[SAVA_MAX_SEGMENTS] = {};
+    uint8_t  _num_segments = 0;
+    uint8_t  _segment_order[SAVA_MAX_SEGMENTS];    // Номера сегментов по возрастанию start
+    void _buildSegmentLut(OutputSegment& seg);
+    bool _allocSegmentLut16(OutputSegment& seg);
+    uint32_t _prep(uint8_t* dst, const uint8_t* src, uint32_t from, uint32_t to, bool dither, bool measure, uint32_t& old_sum);
+    uint32_t _prepSpan(uint8_t* dst, const uint8_t* src, uint32_t from, uint32_t to, bool dither, bool measure, uint32_t& old_sum);
+    uint32_t _prepChannels(const uint8_t* lut, const uint16_t* lut16, uint8_t* dst, const uint8_t* src, uint32_t from, uint32_t to, bool dither, uint32_t& old_sum);
+
+    // --- Ограничение мощности ---
+    SavaPowerModel _power_model;
+    uint32_t  _max_power_mw;
+    uint32_t  _power_mw;                            // Оценка последнего кадра
+    uint16_t  _power_scale;                         // 0..256, применяется в _rebuildLut()
+    uint32_t  _slot_power_sum[SAVA_MAX_PIPELINE];   // Сумма байтов кадра в каждом слоте кольца
+    uint32_t  _prepMeasured(uint8_t* dst, const uint8_t* src, uint32_t from, uint32_t to, bool dither, uint32_t& old_sum);
+    void _updatePower(uint32_t sum);
+
+    bool _double_buffer;
+    bool _encoder_correction;
+
+    // --- Таблицы энкодера (коррекция в энкодере) ---
+    // ISR читает таблицу весь кадр, а _rebuildLut() пишет _lut в любой момент, поэтому энкодер
+    // работает с двумя копиями: изменения попадают в свободную копию между кадрами.
+    uint8_t (*_enc_luts)[4][256];   // [2], во внутренней RAM
+    bool     _enc_lut_mono[2];
+    volatile uint8_t _enc_lut_idx;  // Копия, с которой запускаются новые кадры
+    bool     _enc_lut_stale;        // _lut изменилась после последнего копирования
+    uint32_t _enc_lut_used[2];      // Номер последнего кадра, запущенного с копией
+    uint32_t _frames_submitted;     // Сколько кадров запущено (сравнивается с _frames_done)
+    void _syncEncoderLut();
+
+    // Формат пикселя (задается в begin())
+    SavaPixelFormat _fmt;
+    uint8_t _bpp;
+    uint8_t _white_mask;
+
+    // Готовые RMT-символы для битов 0 и 1 и сигнала сброса
+    rmt_symbol_word_t _bit0;
+    rmt_symbol_word_t _bit1;
+    rmt_symbol_word_t _reset;
+
+    // --- Планировщик эффектов ---
+    struct EffectTransition {
+        uint8_t*       from;            // Буферы пула размером с ленту: выделяются один раз, живут до end()
+        uint8_t*       to;
+        SavaEffect*    next;
+        uint32_t       next_update;     // last_update входящего эффекта
+        uint32_t       start_us;
+        uint32_t       duration_us;
+        SavaTransition type;
+        bool           active;
+        bool           redraw;          // Нарисовать оба эффекта в первом кадре перехода
+    };
+    struct EffectSlot {
+        SavaEffect* effect;
+        SavaSegment seg;
+        int8_t      layer;
+        bool        redraw;         // Нарисовать при следующем runEffects(), даже без шага
+        uint32_t    last_update;    // Время прошлого шага по часам кадра, мкс
+        EffectTransition* transition;
+    };
+    EffectTransition _transitions[SAVA_MAX_TRANSITIONS] = {};
+    EffectSlot _effects[SAVA_MAX_EFFECTS] = {};
+    uint8_t _num_effects = 0;       // Индекс последнего занятого места + 1
+    uint32_t _frame_us = 0;         // Часы кадра (засекаются в show())
+    uint32_t _frame_dt_us = 0;
+    bool _stepEffect(SavaEffect& effect, uint32_t& last_update, const SavaSegment& seg);
+    bool _runTransition(EffectSlot& slot);
+    void _endTransition(EffectSlot& slot);
+    void _freeTransitions();
+
+    friend class SavaRainbowCycleEffect;
+    friend class SavaParticles;
+    friend class SavaMatrix;
+    friend class SavaStreamReceiver;
+    friend class SavaAnimRecorder;
+    friend class SavaAnimPlayer;
+    void _drawRainbow(uint16_t start_pixel, uint16_t num_pixels, bool reversed, uint8_t offset, uint8_t brightness);
+
+    // --- Состояние встроенных эффектов, вызываемых напрямую (rainbowCycle() и др.) ---
+    SavaCometsEffect _comets_effect;
+    uint32_t _comets_last_frame = 0;
+
+    // rainbowCycle() различает свои вызовы по порядку в кадре: i-й вызов - i-й слот
     struct EffectState {
-        uint32_t last_update = 0;
-        uint8_t  counter = 0;
+        uint32_t  last_update = 0;
+        SavaPhase phase;
     };
-    EffectState _effect_slots[5]; // Поддерживаем до 5 независимых эффектов в одном кадре
+    EffectState _effect_slots[SAVA_MAX_EFFECTS];
+    EffectState _breathing_state;
     int _current_effect_slot = 0;
 	
 };
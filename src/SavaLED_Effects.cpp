@@ -0,0 +1,131 @@
+#include "SavaLED_ESP32.h"
+
+uint16_t savaSpeedToInterval(uint8_t speed) {
+    if (speed == 0) speed = 1;
+    return map(speed, 1, 255, 50, 1);
+}
+
+uint32_t savaSpeedToRate(uint8_t speed) {
+    return (1000UL << 16) / savaSpeedToInterval(speed);
+}
+
+// --- Заливка одним цветом ---
+
+bool SavaSolidEffect::update(const SavaTime& t, const SavaSegment& seg) {
+    return color != _drawn;
+}
+
+void SavaSolidEffect::draw(SavaLED_ESP32& strip, const SavaSegment& seg) {
+    strip.fillRange(seg.start, seg.count, color);
+    _drawn = color;
+}
+
+// --- Бегущая радуга ---
+
+SavaRainbowCycleEffect::SavaRainbowCycleEffect(uint8_t speed, uint8_t brightness) : brightness(brightness) {
+    interval_ms = 0; // Скорость задает фаза, шаг - в каждом кадре
+    setSpeed(speed);
+}
+
+void SavaRainbowCycleEffect::setSpeed(uint8_t speed) {
+    _phase.rate = savaSpeedToRate(speed);
+}
+
+bool SavaRainbowCycleEffect::update(const SavaTime& t, const SavaSegment& seg) {
+    return _phase.advance(t.dt_us);
+}
+
+void SavaRainbowCycleEffect::draw(SavaLED_ESP32& strip, const SavaSegment& seg) {
+    strip._drawRainbow(seg.start, seg.count, seg.reversed, _phase.step(), brightness);
+}
+
+// --- "Дышащая" радуга ---
+
+SavaBreathingEffect::SavaBreathingEffect(uint8_t speed, uint8_t brightness) : brightness(brightness) {
+    interval_ms = 0;
+    setSpeed(speed);
+}
+
+void SavaBreathingEffect::setSpeed(uint8_t speed) {
+    _phase.rate = savaSpeedToRate(speed);
+}
+
+bool SavaBreathingEffect::update(const SavaTime& t, const SavaSegment& seg) {
+    return _phase.advance(t.dt_us);
+}
+
+void SavaBreathingEffect::draw(SavaLED_ESP32& strip, const SavaSegment& seg) {
+    strip.fillRange(seg.start, seg.count, strip.ColorHSV(_phase.step(), 255, brightness));
+}
+
+// --- Бегущая палитра ---
+
+SavaPaletteCycleEffect::SavaPaletteCycleEffect(const SavaPalette& palette, uint8_t speed, uint8_t brightness)
+    : brightness(brightness), _palette(&palette) {
+    interval_ms = 0;
+    setSpeed(speed);
+}
+
+void SavaPaletteCycleEffect::setSpeed(uint8_t speed) {
+    _phase.rate = savaSpeedToRate(speed);
+}
+
+bool SavaPaletteCycleEffect::update(const SavaTime& t, const SavaSegment& seg) {
+    // Перерисовка и при смене шага, и каждый кадр: палитра может меняться снаружи (fadeToward())
+    _phase.advance(t.dt_us);
+    return true;
+}
+
+void SavaPaletteCycleEffect::draw(SavaLED_ESP32& strip, const SavaSegment& seg) {
+    strip.fillPalette(seg.start, seg.count, *_palette, seg.reversed, brightness, -(uint8_t)_phase.step());
+}
+
+// --- Кометы ---
+// Комета - частица: появляется на месте за ~1.8 с, затем летит с хвостом до выхода за отрезок.
+
+SavaCometsEffect::SavaCometsEffect(uint8_t num_comets, uint8_t tail_length, const uint32_t* palette, int palette_size,
+                                   uint32_t background_color, uint16_t spawn_interval_ms) {
+    interval_ms = 1000 / 60; // Не чаще 60 шагов в секунду; скорость от шага не зависит
+    configure(num_comets, tail_length, palette, palette_size, background_color, spawn_interval_ms);
+}
+
+void SavaCometsEffect::configure(uint8_t num_comets, uint8_t tail_length, const uint32_t* palette, int palette_size,
+                                 uint32_t background_color, uint16_t spawn_interval_ms) {
+    _num_comets = num_comets;
+    if (_tail != tail_length) setTail(tail_length);
+    _palette = palette;
+    _palette_size = palette_size;
+    background = background_color;
+    _spawn_interval_ms = spawn_interval_ms;
+}
+
+void SavaCometsEffect::_spawn(uint16_t len) {
+    if (!_palette || _palette_size <= 0 || len == 0 || _count >= _num_comets) return;
+    // Пул выделяется при первой комете и растет (с летящими кометами) при увеличении num_comets.
+    // Не хватило памяти - кометы появляются в пределах прежнего пула
+    if (_capacity < _num_comets) {
+        uint16_t capacity = _num_comets > SAVA_MAX_COMETS ? _num_comets : SAVA_MAX_COMETS;
+        if (!reserve(capacity) && _count >= _capacity) return;
+    }
+
+    int position = random(len);
+    int direction;
+    const int edgeZoneSize = len / 4;
+    if (position < edgeZoneSize) direction = 1;
+    else if (position >= len - edgeZoneSize) direction = -1;
+    else direction = (random(2) == 0) ? 1 : -1;
+
+    // Скорость: пиксель за 20..70 мс, в пикселях в секунду 8.8
+    long speed_ms = random(20, 71);
+    int32_t vel = 1000L * SAVA_PX / speed_ms;
+    const uint16_t APPEAR_DURATION_MS = 1800;
+    spawn((int32_t)position * SAVA_PX, direction * vel, _palette[random(_palette_size)], 0, APPEAR_DURATION_MS);
+}
+
+bool SavaCometsEffect::update(const SavaTime& t, const SavaSegment& seg) {
+    if (t.now_us - _last_spawn_us >= _spawn_interval_ms * 1000UL) {
+        _last_spawn_us = t.now_us;
+        _spawn(seg.count);
+    }
+    return SavaParticles::update(t, seg);
+}
@@ -0,0 +1,170 @@
+#ifndef SAVA_LED_EFFECTS_H
+#define SAVA_LED_EFFECTS_H
+
+#include <stdint.h>
+
+/**
+ * Эффекты как объекты. Все состояние эффекта хранится в полях объекта, поэтому
+ * несколько экземпляров (и несколько лент) не мешают друг другу.
+ *
+ * Объекты эффектов создает приложение (обычно глобальные переменные - без кучи),
+ * лента только хранит ссылки на них в таблице фиксированного размера:
+ *
+ *   SavaRainbowCycleEffect rainbow(150);
+ *   strip.addEffect(rainbow, 0, 50);
+ *   ...
+ *   strip.runEffects(); // В каждом кадре перед show()
+ *
+ * Свой эффект - наследник SavaEffect с методами update() и draw().
+ *
+ * Время: лента засекает часы кадра (micros()) один раз в show(), все эффекты кадра
+ * получают одно и то же время и прошедший с их прошлого шага интервал (SavaTime).
+ * Скорость анимации задается в шагах в секунду и накапливается в SavaPhase, поэтому
+ * движение не зависит от FPS и частоты вызовов.
+ */
+
+class SavaLED_ESP32;
+
+// Отрезок ленты, на котором работает эффект
+struct SavaSegment {
+    uint16_t start;
+    uint16_t count;
+    bool     reversed;  // true - эффект идет от последнего пикселя отрезка к первому
+};
+
+// Часы кадра для шага эффекта
+struct SavaTime {
+    uint32_t now_us;    // Время текущего кадра (micros(), засекается в show())
+    uint32_t dt_us;     // Сколько прошло с прошлого шага этого эффекта
+};
+
+/**
+ * Фазовый аккумулятор Q16.16: целая часть - номер шага анимации (например, тон радуги),
+ * дробная - накопленный остаток. За dt_us фаза растет на rate * dt_us / 1e6, дробные
+ * шаги не теряются при любой частоте кадров.
+ */
+struct SavaPhase {
+    uint32_t value = 0;
+    uint32_t rate = 0;  // Шагов в секунду, Q16.16
+
+    // Продвигает фазу и возвращает true, если сменился целый шаг
+    bool advance(uint32_t dt_us) {
+        uint32_t prev = value >> 16;
+        // rate * dt_us / 1000000: 4295 / 2^32 ~ 1 / 1000000 (деление не нужно)
+        value += (uint32_t)(((uint64_t)rate * dt_us * 4295) >> 32);
+        return (value >> 16) != prev;
+    }
+    uint16_t step() const { return value >> 16; }
+};
+
+class SavaEffect {
+public:
+    virtual ~SavaEffect() {}
+    /**
+    * @brief Шаг анимации. Планировщик вызывает его не чаще, чем раз в interval_ms.
+    * @param t Время кадра и интервал с прошлого шага этого эффекта.
+    * @return true, если картинка изменилась и отрезок нужно перерисовать.
+    */
+    virtual bool update(const SavaTime& t, const SavaSegment& seg) = 0;
+    // Рисует текущее состояние эффекта на отрезке seg
+    virtual void draw(SavaLED_ESP32& strip, const SavaSegment& seg) = 0;
+
+    uint16_t interval_ms = 20;  // Минимальный период шага (0 - шаг в каждом кадре)
+};
+
+// Переход между эффектами одного места планировщика (transitionEffect())
+enum SavaTransition : uint8_t {
+    SAVA_TRANSITION_CUT,        // Мгновенная смена
+    SAVA_TRANSITION_FADE,       // Плавное смешивание
+    SAVA_TRANSITION_WIPE,       // Новый эффект вытесняет старый от начала отрезка
+    SAVA_TRANSITION_DISSOLVE    // Пиксели сменяются в случайном (но постоянном) порядке
+};
+
+// Перевод скорости 1..255 встроенных эффектов в период шага (50..1 мс)
+uint16_t savaSpeedToInterval(uint8_t speed);
+// То же как скорость для SavaPhase: 20..1000 шагов в секунду, Q16.16
+uint32_t savaSpeedToRate(uint8_t speed);
+
+// --- Заливка одним цветом (как fill()): например, плавный переход к цвету или к черному ---
+class SavaSolidEffect : public SavaEffect {
+public:
+    explicit SavaSolidEffect(uint32_t color = 0) : color(color) {}
+    bool update(const SavaTime& t, const SavaSegment& seg) override;
+    void draw(SavaLED_ESP32& strip, const SavaSegment& seg) override;
+
+    uint32_t color;             // Можно менять на лету: отрезок перерисуется в следующем кадре
+private:
+    uint32_t _drawn = 0;
+};
+
+// --- Бегущая радуга (как rainbowCycle()) ---
+class SavaRainbowCycleEffect : public SavaEffect {
+public:
+    explicit SavaRainbowCycleEffect(uint8_t speed = 128, uint8_t brightness = 255);
+    void setSpeed(uint8_t speed);
+    bool update(const SavaTime& t, const SavaSegment& seg) override;
+    void draw(SavaLED_ESP32& strip, const SavaSegment& seg) override;
+
+    uint8_t brightness;
+private:
+    SavaPhase _phase;
+};
+
+// --- "Дышащая" радуга: весь отрезок одним цветом, тон меняется по кругу (как breathingRainbow()) ---
+class SavaBreathingEffect : public SavaEffect {
+public:
+    explicit SavaBreathingEffect(uint8_t speed = 128, uint8_t brightness = 255);
+    void setSpeed(uint8_t speed);
+    bool update(const SavaTime& t, const SavaSegment& seg) override;
+    void draw(SavaLED_ESP32& strip, const SavaSegment& seg) override;
+
+    uint8_t brightness;
+private:
+    SavaPhase _phase;
+};
+
+// --- Бегущая палитра: как SavaRainbowCycleEffect, но с любой палитрой (SavaLED_Palette.h) ---
+class SavaPaletteCycleEffect : public SavaEffect {
+public:
+    // Палитра не копируется: ее можно менять (и плавно переводить fadeToward()) на лету
+    explicit SavaPaletteCycleEffect(const SavaPalette& palette, uint8_t speed = 128, uint8_t brightness = 255);
+    void setSpeed(uint8_t speed);
+    void setPalette(const SavaPalette& palette) { _palette = &palette; }
+    bool update(const SavaTime& t, const SavaSegment& seg) override;
+    void draw(SavaLED_ESP32& strip, const SavaSegment& seg) override;
+
+    uint8_t brightness;
+private:
+    const SavaPalette* _palette;
+    SavaPhase _phase;
+};
+
+// --- Частицы (SavaLED_Particles.h) и кометы на их основе ---
+#include "SavaLED_Particles.h"
+
+// Начальный размер пула комет (растет, если запрошено больше)
+#ifndef SAVA_MAX_COMETS
+#define SAVA_MAX_COMETS 10
+#endif
+
+// Кометы (как runCometsEffect()): появляются на месте и улетают с хвостом
+class SavaCometsEffect : public SavaParticles {
+public:
+    SavaCometsEffect(uint8_t num_comets = 5, uint8_t tail_length = 10, const uint32_t* palette = nullptr, int palette_size = 0,
+                     uint32_t background_color = 0, uint16_t spawn_interval_ms = 1500);
+    // Меняет параметры на лету, летящие кометы сохраняются
+    void configure(uint8_t num_comets, uint8_t tail_length, const uint32_t* palette, int palette_size,
+                   uint32_t background_color, uint16_t spawn_interval_ms);
+    bool update(const SavaTime& t, const SavaSegment& seg) override;
+
+private:
+    uint8_t         _num_comets;
+    const uint32_t* _palette;
+    int             _palette_size;
+    uint16_t        _spawn_interval_ms;
+    uint32_t        _last_spawn_us = 0;
+
+    void _spawn(uint16_t len);
+};
+
+#endif // SAVA_LED_EFFECTS_H
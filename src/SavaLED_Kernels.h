@@ -0,0 +1,218 @@
+#ifndef SAVA_LED_KERNELS_H
+#define SAVA_LED_KERNELS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * Ядра обработки буфера пикселей целиком: масштабирование яркости, затухание,
+ * сложение с насыщением и смешивание (lerp), а также режимы наложения слоев.
+ *
+ * SAVA_KERNELS_SWAR = 1 (по умолчанию) - "векторный" вариант: 4 канала за одну
+ * 32-битную операцию (SWAR, SIMD внутри регистра). 0 - простой побайтовый вариант.
+ * Оба варианта дают побитово одинаковый результат.
+ *
+ * Везде вес w - в диапазоне 0..256, результат канала = (x * w) >> 8.
+ * Промежуточное значение канала не превышает 255 * 256 = 65280 и помещается
+ * в 16-битную "полосу" слова, поэтому полосы не мешают друг другу.
+ */
+#ifndef SAVA_KERNELS_SWAR
+#define SAVA_KERNELS_SWAR 1
+#endif
+
+// Перевод 0..255 в вес 0..256, чтобы 255 означало "полностью" без потери единицы
+static inline uint16_t savaWeight(uint8_t amount) {
+    return amount + (amount >> 7);
+}
+
+// --- Побайтовые (эталонные) варианты ---
+
+static inline void savaScaleScalar(uint8_t* buf, size_t len, uint16_t w) {
+    for (size_t i = 0; i < len; i++) buf[i] = ((uint32_t)buf[i] * w) >> 8;
+}
+
+static inline void savaAddSatScalar(uint8_t* dst, const uint8_t* src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uint16_t v = dst[i] + src[i];
+        dst[i] = v > 255 ? 255 : v;
+    }
+}
+
+static inline void savaBlendScalar(uint8_t* dst, const uint8_t* src, size_t len, uint16_t w) {
+    uint16_t iw = 256 - w;
+    for (size_t i = 0; i < len; i++) dst[i] = ((uint32_t)dst[i] * iw + (uint32_t)src[i] * w) >> 8;
+}
+
+// Смесь двух буферов в третий: dst = a + (b - a) * w / 256
+static inline void savaMixScalar(uint8_t* dst, const uint8_t* a, const uint8_t* b, size_t len, uint16_t w) {
+    uint16_t iw = 256 - w;
+    for (size_t i = 0; i < len; i++) dst[i] = ((uint32_t)a[i] * iw + (uint32_t)b[i] * w) >> 8;
+}
+
+#if SAVA_KERNELS_SWAR
+// --- SWAR: четыре канала в одном 32-битном слове ---
+
+static inline uint32_t savaScaleWord(uint32_t x, uint16_t w) {
+    uint32_t lo = (((x & 0x00FF00FFu) * w) >> 8) & 0x00FF00FFu;
+    uint32_t hi = (((x >> 8) & 0x00FF00FFu) * w) & 0xFF00FF00u;
+    return lo | hi;
+}
+
+static inline uint32_t savaAddSatWord(uint32_t a, uint32_t b) {
+    uint32_t low = (a & 0x7F7F7F7Fu) + (b & 0x7F7F7F7Fu);    // Сумма младших 7 бит без переносов между байтами
+    uint32_t sum = low ^ ((a ^ b) & 0x80808080u);             // Сумма по модулю 256 в каждом байте
+    uint32_t carry = ((a & b) | ((a | b) & ~sum)) & 0x80808080u; // Перенос из старшего бита байта
+    return sum | ((carry >> 7) * 0xFFu);                      // Переполненные байты -> 255
+}
+
+static inline uint32_t savaBlendWord(uint32_t d, uint32_t s, uint16_t w) {
+    uint16_t iw = 256 - w;
+    uint32_t lo = (((d & 0x00FF00FFu) * iw + (s & 0x00FF00FFu) * w) >> 8) & 0x00FF00FFu;
+    uint32_t hi = (((d >> 8) & 0x00FF00FFu) * iw + ((s >> 8) & 0x00FF00FFu) * w) & 0xFF00FF00u;
+    return lo | hi;
+}
+
+// Обработка невыровненного начала/конца побайтово, середины - словами.
+// Для двух буферов слова используются, только если их выравнивание совпадает.
+static inline void savaScale(uint8_t* buf, size_t len, uint16_t w) {
+    size_t head = (4 - ((uintptr_t)buf & 3)) & 3;
+    if (head > len) head = len;
+    savaScaleScalar(buf, head, w);
+    buf += head; len -= head;
+    uint32_t* p = (uint32_t*)buf;
+    for (size_t n = len >> 2; n; n--, p++) *p = savaScaleWord(*p, w);
+    savaScaleScalar((uint8_t*)p, len & 3, w);
+}
+
+static inline void savaAddSat(uint8_t* dst, const uint8_t* src, size_t len) {
+    if (((uintptr_t)dst ^ (uintptr_t)src) & 3) { savaAddSatScalar(dst, src, len); return; }
+    size_t head = (4 - ((uintptr_t)dst & 3)) & 3;
+    if (head > len) head = len;
+    savaAddSatScalar(dst, src, head);
+    dst += head; src += head; len -= head;
+    uint32_t* d = (uint32_t*)dst;
+    const uint32_t* s = (const uint32_t*)src;
+    for (size_t n = len >> 2; n; n--, d++, s++) *d = savaAddSatWord(*d, *s);
+    savaAddSatScalar((uint8_t*)d, (const uint8_t*)s, len & 3);
+}
+
+static inline void savaBlend(uint8_t* dst, const uint8_t* src, size_t len, uint16_t w) {
+    if (((uintptr_t)dst ^ (uintptr_t)src) & 3) { savaBlendScalar(dst, src, len, w); return; }
+    size_t head = (4 - ((uintptr_t)dst & 3)) & 3;
+    if (head > len) head = len;
+    savaBlendScalar(dst, src, head, w);
+    dst += head; src += head; len -= head;
+    uint32_t* d = (uint32_t*)dst;
+    const uint32_t* s = (const uint32_t*)src;
+    for (size_t n = len >> 2; n; n--, d++, s++) *d = savaBlendWord(*d, *s, w);
+    savaBlendScalar((uint8_t*)d, (const uint8_t*)s, len & 3, w);
+}
+
+static inline void savaMix(uint8_t* dst, const uint8_t* a, const uint8_t* b, size_t len, uint16_t w) {
+    if ((((uintptr_t)dst ^ (uintptr_t)a) | ((uintptr_t)dst ^ (uintptr_t)b)) & 3) { savaMixScalar(dst, a, b, len, w); return; }
+    size_t head = (4 - ((uintptr_t)dst & 3)) & 3;
+    if (head > len) head = len;
+    savaMixScalar(dst, a, b, head, w);
+    dst += head; a += head; b += head; len -= head;
+    uint32_t* d = (uint32_t*)dst;
+    const uint32_t* wa = (const uint32_t*)a;
+    const uint32_t* wb = (const uint32_t*)b;
+    for (size_t n = len >> 2; n; n--, d++, wa++, wb++) *d = savaBlendWord(*wa, *wb, w);
+    savaMixScalar((uint8_t*)d, (const uint8_t*)wa, (const uint8_t*)wb, len & 3, w);
+}
+
+// Операции с постоянным цветом: шаблон из 3 слов = 4 пикселя RGB или 3 пикселя RGBW.
+// dst должен быть выровнен на 4 байта и начинаться с первого байта пикселя (начало буфера).
+static inline void savaAddSatPattern(uint8_t* dst, size_t len, const uint8_t pattern[12]) {
+    uint32_t pw[3];
+    memcpy(pw, pattern, 12);
+    uint32_t* d = (uint32_t*)dst;
+    size_t words = len >> 2;
+    for (size_t i = 0; i < words; i++) d[i] = savaAddSatWord(d[i], pw[i % 3]);
+    savaAddSatScalar((uint8_t*)(d + words), pattern + (words % 3) * 4, len & 3);
+}
+
+static inline void savaBlendPattern(uint8_t* dst, size_t len, const uint8_t pattern[12], uint16_t w) {
+    uint32_t pw[3];
+    memcpy(pw, pattern, 12);
+    uint32_t* d = (uint32_t*)dst;
+    size_t words = len >> 2;
+    for (size_t i = 0; i < words; i++) d[i] = savaBlendWord(d[i], pw[i % 3], w);
+    savaBlendScalar((uint8_t*)(d + words), pattern + (words % 3) * 4, len & 3, w);
+}
+
+#else
+// --- Побайтовый вариант для отладки и сравнения ---
+
+static inline void savaScale(uint8_t* buf, size_t len, uint16_t w) {
+    savaScaleScalar(buf, len, w);
+}
+
+static inline void savaAddSat(uint8_t* dst, const uint8_t* src, size_t len) {
+    savaAddSatScalar(dst, src, len);
+}
+
+static inline void savaBlend(uint8_t* dst, const uint8_t* src, size_t len, uint16_t w) {
+    savaBlendScalar(dst, src, len, w);
+}
+
+static inline void savaMix(uint8_t* dst, const uint8_t* a, const uint8_t* b, size_t len, uint16_t w) {
+    savaMixScalar(dst, a, b, len, w);
+}
+
+static inline void savaAddSatPattern(uint8_t* dst, size_t len, const uint8_t pattern[12]) {
+    for (size_t i = 0; i < len; i += 12) savaAddSatScalar(dst + i, pattern, len - i < 12 ? len - i : 12);
+}
+
+static inline void savaBlendPattern(uint8_t* dst, size_t len, const uint8_t pattern[12], uint16_t w) {
+    for (size_t i = 0; i < len; i += 12) savaBlendScalar(dst + i, pattern, len - i < 12 ? len - i : 12, w);
+}
+#endif
+
+// --- Режимы наложения слоев. w - непрозрачность слоя 0..256 ---
+// Результат режима x подмешивается к dst с весом w: dst + (x - dst) * w / 256.
+
+static inline uint8_t savaMul8(uint8_t a, uint8_t b) {
+    return ((uint16_t)a * b + 255) >> 8; // a * b / 255: 255 * 255 = 255, 0 * x = 0
+}
+
+static inline uint8_t savaLerp8(uint8_t d, uint8_t x, uint16_t w) {
+    return d + (((int32_t)x - d) * (int32_t)w >> 8);
+}
+
+static inline void savaLayerAdd(uint8_t* dst, const uint8_t* src, size_t len, uint16_t w) {
+    if (w >= 256) { savaAddSat(dst, src, len); return; }
+    for (size_t i = 0; i < len; i++) {
+        uint16_t v = dst[i] + (((uint32_t)src[i] * w) >> 8);
+        dst[i] = v > 255 ? 255 : v;
+    }
+}
+
+static inline void savaLayerMax(uint8_t* dst, const uint8_t* src, size_t len, uint16_t w) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t x = src[i] > dst[i] ? src[i] : dst[i];
+        dst[i] = savaLerp8(dst[i], x, w);
+    }
+}
+
+static inline void savaLayerMultiply(uint8_t* dst, const uint8_t* src, size_t len, uint16_t w) {
+    for (size_t i = 0; i < len; i++) dst[i] = savaLerp8(dst[i], savaMul8(dst[i], src[i]), w);
+}
+
+static inline void savaLayerScreen(uint8_t* dst, const uint8_t* src, size_t len, uint16_t w) {
+    for (size_t i = 0; i < len; i++) dst[i] = savaLerp8(dst[i], 255 - savaMul8(255 - dst[i], 255 - src[i]), w);
+}
+
+// Наложение с цветовым ключом: черный пиксель слоя прозрачен, остальные смешиваются с весом w.
+static inline void savaLayerKeyed(uint8_t* dst, const uint8_t* src, size_t len, uint8_t bpp, uint16_t w) {
+    for (size_t i = 0; i < len; i += bpp) {
+        uint8_t any = 0;
+        for (uint8_t c = 0; c < bpp; c++) any |= src[i + c];
+        if (!any) continue;
+        if (w >= 256) memcpy(dst + i, src + i, bpp);
+        else savaBlendScalar(dst + i, src + i, bpp, w);
+    }
+}
+
+#endif // SAVA_LED_KERNELS_H
@@ -0,0 +1,193 @@
+#include "SavaLED_Matrix.h"
+#include "esp_heap_caps.h"
+
+SavaMatrix::~SavaMatrix() {
+    heap_caps_free(_map);
+}
+
+bool SavaMatrix::begin(const SavaMatrixLayout& layout, uint16_t offset) {
+    heap_caps_free(_map);
+    _map = nullptr;
+    _width = _height = 0;
+
+    const uint16_t pw = layout.panel_width, ph = layout.panel_height;
+    const uint32_t W = (uint32_t)pw * layout.tiles_x, H = (uint32_t)ph * layout.tiles_y; // Физический размер
+    if (W == 0 || H == 0 || W * H > 0xFFFF) return false;
+    const uint8_t rot = layout.rotation & 3;
+    const uint16_t w = (rot & 1) ? H : W, h = (rot & 1) ? W : H;
+
+    _map = (uint16_t*)heap_caps_malloc(W * H * sizeof(uint16_t), MALLOC_CAP_8BIT);
+    if (!_map) return false;
+
+    const uint16_t num_leds = _strip.getNumLeds();
+    for (uint16_t y = 0; y < h; y++) {
+        for (uint16_t x = 0; x < w; x++) {
+            // Поворот: логическая точка -> точка на физической поверхности панелей
+            uint16_t gx, gy;
+            switch (rot) {
+                case 0:  gx = x;         gy = y;         break;
+                case 1:  gx = W - 1 - y; gy = x;         break;
+                case 2:  gx = W - 1 - x; gy = H - 1 - y; break;
+                default: gx = y;         gy = H - 1 - x; break;
+            }
+            // Панель в цепочке
+            uint16_t tx = gx / pw, ty = gy / ph;
+            if (layout.tile_serpentine && (ty & 1)) tx = layout.tiles_x - 1 - tx;
+            uint32_t tile = (uint32_t)ty * layout.tiles_x + tx;
+            // Точка внутри панели
+            uint16_t px = gx % pw, py = gy % ph;
+            if (layout.flip_x) px = pw - 1 - px;
+            if (layout.flip_y) py = ph - 1 - py;
+            uint16_t row = layout.vertical ? px : py;
+            uint16_t col = layout.vertical ? py : px;
+            uint16_t row_len = layout.vertical ? ph : pw;
+            if (layout.serpentine && (row & 1)) col = row_len - 1 - col;
+
+            uint32_t n = offset + tile * pw * ph + (uint32_t)row * row_len + col;
+            _map[(uint32_t)y * w + x] = n < num_leds ? n : SAVA_MATRIX_NONE;
+        }
+    }
+    _width = w;
+    _height = h;
+    return true;
+}
+
+uint16_t SavaMatrix::XY(int16_t x, int16_t y) const {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return SAVA_MATRIX_NONE;
+    return _map[(uint32_t)y * _width + x];
+}
+
+// Запись в текущий буфер ленты без проверок границ ленты (таблица их уже учла)
+inline void SavaMatrix::_put(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
+    if (n == SAVA_MATRIX_NONE) return;
+    _strip._writePixel(_strip._pixels + (uint32_t)n * _strip._bpp, r, g, b);
+    if (n < _dirty_lo) _dirty_lo = n;
+    if (n >= _dirty_hi) _dirty_hi = n + 1;
+}
+
+void SavaMatrix::_opEnd() {
+    if (_dirty_lo < _dirty_hi) _strip._markDirty(_dirty_lo, _dirty_hi);
+}
+
+void SavaMatrix::setPixel(int16_t x, int16_t y, uint32_t color) {
+    uint16_t n = XY(x, y);
+    if (n == SAVA_MATRIX_NONE || !_strip._pixels) return;
+    _opBegin();
+    _put(n, color >> 16, color >> 8, color);
+    _opEnd();
+}
+
+uint32_t SavaMatrix::getPixel(int16_t x, int16_t y) const {
+    uint16_t n = XY(x, y);
+    if (n == SAVA_MATRIX_NONE || !_strip._pixels) return 0;
+    const SavaPixelFormat& f = _strip._fmt;
+    const uint8_t* p = _strip._pixels + (uint32_t)n * _strip._bpp;
+    uint16_t w = _strip._bpp == 4 ? p[f.w] : 0; // Белый канал возвращаем в R, G, B
+    uint16_t r = p[f.r] + w, g = p[f.g] + w, b = p[f.b] + w;
+    return _strip.Color(r > 255 ? 255 : r, g > 255 ? 255 : g, b > 255 ? 255 : b);
+}
+
+// Горизонтальный отрезок [x0, x1] на строке y, уже обрезанный по матрице
+void SavaMatrix::_hLine(int16_t x0, int16_t x1, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+    const uint16_t* row = _map + (uint32_t)y * _width;
+    for (int16_t x = x0; x <= x1; x++) _put(row[x], r, g, b);
+}
+
+void SavaMatrix::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint32_t color) {
+    if (!_map || !_strip._pixels) return;
+    uint8_t r = color >> 16, g = color >> 8, b = color;
+    _opBegin();
+    // Брезенхем: только целочисленные сложения, точки вне матрицы пропускаются
+    int16_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int16_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    while (true) {
+        _put(XY(x0, y0), r, g, b);
+        if (x0 == x1 && y0 == y1) break;
+        int32_t e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+    _opEnd();
+}
+
+void SavaMatrix::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color) {
+    if (w <= 0 || h <= 0) return;
+    drawLine(x, y, x + w - 1, y, color);
+    drawLine(x, y + h - 1, x + w - 1, y + h - 1, color);
+    drawLine(x, y, x, y + h - 1, color);
+    drawLine(x + w - 1, y, x + w - 1, y + h - 1, color);
+}
+
+void SavaMatrix::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color) {
+    if (!_map || !_strip._pixels) return;
+    // Обрезаем по матрице один раз, внутри циклов проверок нет
+    int32_t x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+    int32_t x1 = (int32_t)x + w, y1 = (int32_t)y + h;
+    if (x1 > _width) x1 = _width;
+    if (y1 > _height) y1 = _height;
+    x1--; y1--;
+    if (x0 > x1 || y0 > y1) return;
+    _opBegin();
+    for (int32_t row = y0; row <= y1; row++) _hLine(x0, x1, row, color >> 16, color >> 8, color);
+    _opEnd();
+}
+
+void SavaMatrix::fill(uint32_t color) {
+    fillRect(0, 0, _width, _height, color);
+}
+
+void SavaMatrix::scroll(int16_t dx, int16_t dy, uint32_t fill_color) {
+    if (!_map || !_strip._pixels) return;
+    uint8_t* pixels = _strip._pixels;
+    const uint8_t bpp = _strip._bpp;
+    uint8_t r = fill_color >> 16, g = fill_color >> 8, b = fill_color;
+    _opBegin();
+    // Обход навстречу сдвигу: источник читается раньше, чем его перезапишут
+    for (int16_t i = 0; i < _height; i++) {
+        int16_t y = dy > 0 ? _height - 1 - i : i;
+        for (int16_t j = 0; j < _width; j++) {
+            int16_t x = dx > 0 ? _width - 1 - j : j;
+            uint16_t n = _map[(uint32_t)y * _width + x];
+            if (n == SAVA_MATRIX_NONE) continue;
+            uint16_t src = XY(x - dx, y - dy);
+            if (src == SAVA_MATRIX_NONE) {
+                _put(n, r, g, b);
+            } else {
+                memcpy(pixels + (uint32_t)n * bpp, pixels + (uint32_t)src * bpp, bpp);
+                if (n < _dirty_lo) _dirty_lo = n;
+                if (n >= _dirty_hi) _dirty_hi = n + 1;
+            }
+        }
+    }
+    _opEnd();
+}
+
+void SavaMatrix::blit(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint32_t* colors, uint16_t stride) {
+    if (!_map || !_strip._pixels || !colors) return;
+    if (!stride) stride = w;
+    _opBegin();
+    for (uint16_t j = 0; j < h; j++) {
+        int16_t ty = y + j;
+        if (ty < 0 || ty >= _height) continue;
+        const uint32_t* src = colors + (uint32_t)j * stride;
+        for (uint16_t i = 0; i < w; i++) {
+            uint32_t c = src[i];
+            _put(XY(x + i, ty), c >> 16, c >> 8, c);
+        }
+    }
+    _opEnd();
+}
+
+void SavaMatrix::blitRGB(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t* rgb, uint16_t stride) {
+    if (!_map || !_strip._pixels || !rgb) return;
+    if (!stride) stride = w;
+    _opBegin();
+    for (uint16_t j = 0; j < h; j++) {
+        int16_t ty = y + j;
+        if (ty < 0 || ty >= _height) continue;
+        const uint8_t* src = rgb + (uint32_t)j * stride * 3;
+        for (uint16_t i = 0; i < w; i++, src += 3) _put(XY(x + i, ty), src[0], src[1], src[2]);
+    }
+    _opEnd();
+}
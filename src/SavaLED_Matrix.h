@@ -0,0 +1,93 @@
+#ifndef SAVA_LED_MATRIX_H
+#define SAVA_LED_MATRIX_H
+
+#include "SavaLED_ESP32.h"
+
+/**
+ * Матрицы и панели: координаты (x, y) поверх линейной ленты.
+ *
+ * Раскладка (змейка, направление рядов, угол начала, поворот, несколько панелей)
+ * переводится в таблицу "координата -> номер светодиода" один раз в begin().
+ * Дальше каждая запись - это одно чтение таблицы и запись прямо в буфер ленты,
+ * без пересчета змейки и панелей на каждый пиксель.
+ *
+ *   SavaMatrix matrix(strip);
+ *   SavaMatrixLayout layout;       // Одна панель 16x16, змейка по строкам
+ *   layout.panel_width = 16;
+ *   layout.panel_height = 16;
+ *   matrix.begin(layout);          // После strip.begin()
+ *   matrix.drawLine(0, 0, 15, 15, RED);
+ *
+ * Рисование идет в текущий буфер ленты, поэтому работает со слоями (drawToLayer())
+ * и двойной буферизацией так же, как функции самой ленты.
+ */
+
+// XY() для точки вне матрицы
+#define SAVA_MATRIX_NONE 0xFFFF
+
+// Раскладка светодиодов матрицы
+struct SavaMatrixLayout {
+    uint16_t panel_width = 8;           // Размер одной панели в пикселях
+    uint16_t panel_height = 8;
+    uint8_t  tiles_x = 1;               // Панелей по горизонтали и вертикали
+    uint8_t  tiles_y = 1;
+    bool     serpentine = true;         // Змейка: каждый второй ряд идет в обратную сторону
+    bool     vertical = false;          // Ряды проводки - столбцы, а не строки
+    bool     flip_x = false;            // Первый светодиод панели справа (иначе слева)
+    bool     flip_y = false;            // Первый светодиод панели снизу (иначе сверху)
+    bool     tile_serpentine = false;   // Цепочка панелей змейкой: нечетные ряды панелей справа налево
+    uint8_t  rotation = 0;              // Поворот картинки на rotation * 90° по часовой стрелке
+};
+
+class SavaMatrix {
+public:
+    explicit SavaMatrix(SavaLED_ESP32& strip) : _strip(strip) {}
+    ~SavaMatrix();
+    SavaMatrix(const SavaMatrix&) = delete;
+    SavaMatrix& operator=(const SavaMatrix&) = delete;
+
+    /**
+    * @brief Строит таблицу координат. Вызывать после strip.begin().
+    * @param offset Номер светодиода, с которого начинается матрица на ленте.
+    * @return false, если не хватило памяти или раскладка пустая.
+    *         Пиксели, которые не помещаются на ленту, пропускаются при рисовании.
+    */
+    bool begin(const SavaMatrixLayout& layout, uint16_t offset = 0);
+    uint16_t width() const { return _width; }
+    uint16_t height() const { return _height; }
+    // Номер светодиода для (x, y) или SAVA_MATRIX_NONE (вне матрицы или за концом ленты)
+    uint16_t XY(int16_t x, int16_t y) const;
+
+    void setPixel(int16_t x, int16_t y, uint32_t color);
+    uint32_t getPixel(int16_t x, int16_t y) const;
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint32_t color);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color);
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color);
+    void fill(uint32_t color);
+    /**
+    * @brief Сдвигает картинку на (dx, dy) пикселей, освободившееся место заливается fill_color.
+    *        Байты пикселей переносятся как есть, без перевода цвета.
+    */
+    void scroll(int16_t dx, int16_t dy, uint32_t fill_color = BLACK);
+    /**
+    * @brief Копирует прямоугольник w x h из кадра приложения в точку (x, y) (обрезается по краям).
+    * @param colors Цвета 0xRRGGBB построчно, stride - длина строки источника (0 - равна w).
+    */
+    void blit(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint32_t* colors, uint16_t stride = 0);
+    // То же из массива байтов R, G, B (например, картинки в PROGMEM-массиве)
+    void blitRGB(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint8_t* rgb, uint16_t stride = 0);
+
+private:
+    SavaLED_ESP32& _strip;
+    uint16_t* _map = nullptr;   // _map[y * _width + x] - номер светодиода
+    uint16_t  _width = 0;
+    uint16_t  _height = 0;
+    uint16_t  _dirty_lo, _dirty_hi; // Затронутый диапазон ленты за одну операцию
+
+    inline void _put(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+    void _hLine(int16_t x0, int16_t x1, int16_t y, uint8_t r, uint8_t g, uint8_t b);
+    void _opBegin() { _dirty_lo = UINT16_MAX; _dirty_hi = 0; }
+    void _opEnd();
+};
+
+#endif // SAVA_LED_MATRIX_H
@@ -0,0 +1,113 @@
+#include "SavaLED_ESP32.h"
+
+const uint32_t SAVA_PALETTE_RAINBOW[16] = {
+    0xFF0000, 0xFF6000, 0xFFBF00, 0xDFFF00, 0x80FF00, 0x20FF00, 0x00FF40, 0x00FF9F,
+    0x00FFFF, 0x009FFF, 0x0040FF, 0x2000FF, 0x8000FF, 0xDF00FF, 0xFF00BF, 0xFF0060
+};
+
+const uint32_t SAVA_PALETTE_HEAT[16] = {
+    0x000000, 0x200000, 0x400000, 0x700000, 0xA00000, 0xD01000, 0xFF2000, 0xFF4000,
+    0xFF6000, 0xFF8000, 0xFFA000, 0xFFC000, 0xFFE000, 0xFFFF40, 0xFFFFA0, 0xFFFFFF
+};
+
+const uint32_t SAVA_PALETTE_OCEAN[16] = {
+    0x000020, 0x000040, 0x000070, 0x0000A0, 0x0020C0, 0x0040E0, 0x0060FF, 0x0080FF,
+    0x00A0E0, 0x00C0C0, 0x00E0D0, 0x20FFE0, 0x60FFF0, 0x0080FF, 0x0040C0, 0x000060
+};
+
+const uint32_t SAVA_PALETTE_FOREST[16] = {
+    0x002000, 0x004000, 0x006000, 0x008000, 0x20A000, 0x40C000, 0x60A000, 0x408000,
+    0x206010, 0x406020, 0x608020, 0x80A030, 0x60C040, 0x30A020, 0x108010, 0x004000
+};
+
+SavaPalette::SavaPalette() {
+    set16(SAVA_PALETTE_RAINBOW);
+}
+
+SavaPalette::SavaPalette(const uint32_t colors[16]) {
+    set16(colors);
+}
+
+void SavaPalette::set16(const uint32_t colors[16]) {
+    for (uint8_t i = 0; i < 16; i++) {
+        _stops[i].pos = i * 17; // 0, 17, ..., 255
+        _stops[i].color = colors[i];
+    }
+    _num_stops = 16;
+    _lut_valid = false;
+}
+
+void SavaPalette::setGradient(const SavaGradientStop* stops, uint8_t count) {
+    if (count > SAVA_PALETTE_STOPS) count = SAVA_PALETTE_STOPS;
+    if (count == 0) {
+        _stops[0] = {0, 0};
+        count = 1;
+    } else {
+        memcpy(_stops, stops, count * sizeof(SavaGradientStop));
+    }
+    _num_stops = count;
+    _lut_valid = false;
+}
+
+// Разворачивает опорные точки в таблицу: линейная интерполяция каналов между соседними точками
+void SavaPalette::_build() const {
+    const SavaGradientStop* s = _stops;
+    uint8_t k = 0; // Первая точка с pos >= i
+    for (uint16_t i = 0; i < 256; i++) {
+        while (k < _num_stops && s[k].pos < i) k++;
+        if (k == 0 || k == _num_stops) {
+            uint32_t c = s[k ? k - 1 : 0].color;
+            _lut[i][0] = c >> 16;
+            _lut[i][1] = c >> 8;
+            _lut[i][2] = c;
+            continue;
+        }
+        uint32_t ca = s[k - 1].color, cb = s[k].color;
+        uint16_t w = (uint16_t)((i - s[k - 1].pos) * 256 / (s[k].pos - s[k - 1].pos)); // 0..256
+        _lut[i][0] = savaLerp8(ca >> 16, cb >> 16, w);
+        _lut[i][1] = savaLerp8(ca >> 8, cb >> 8, w);
+        _lut[i][2] = savaLerp8(ca, cb, w);
+    }
+    _lut_valid = true;
+}
+
+const uint8_t* SavaPalette::lut() const {
+    if (!_lut_valid) _build();
+    return &_lut[0][0];
+}
+
+uint32_t SavaPalette::color(uint8_t index, uint8_t brightness) const {
+    const uint8_t* p = lut() + index * 3;
+    if (brightness == 255) return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    uint16_t w = savaWeight(brightness);
+    return (((uint32_t)p[0] * w >> 8) << 16) | (((uint32_t)p[1] * w >> 8) << 8) | ((uint32_t)p[2] * w >> 8);
+}
+
+bool SavaPalette::fadeToward(const SavaPalette& target, uint8_t max_step) {
+    uint8_t* dst = (uint8_t*)lut();
+    const uint8_t* src = target.lut();
+    bool changed = false;
+    for (uint16_t i = 0; i < 256 * 3; i++) {
+        uint8_t d = dst[i], t = src[i];
+        if (d == t) continue;
+        changed = true;
+        if (d < t) dst[i] = (t - d > max_step) ? d + max_step : t;
+        else       dst[i] = (d - t > max_step) ? d - max_step : t;
+    }
+    return changed;
+}
+
+void SavaPalette::blend(const SavaPalette& from, const SavaPalette& to, uint8_t amount) {
+    uint8_t* dst = &_lut[0][0];
+    // to - эта же палитра: ее таблицу затрет from, поэтому цель копируется до этого
+    uint8_t copy[256 * 3];
+    const uint8_t* target = to.lut();
+    if (&to == this) {
+        memcpy(copy, target, sizeof(copy));
+        target = copy;
+    }
+    if (&from != this) memcpy(dst, from.lut(), 256 * 3);
+    else lut();
+    savaBlend(dst, target, 256 * 3, savaWeight(amount));
+    _lut_valid = true;
+}
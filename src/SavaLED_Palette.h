@@ -0,0 +1,71 @@
+#ifndef SAVA_LED_PALETTE_H
+#define SAVA_LED_PALETTE_H
+
+#include <stdint.h>
+
+/**
+ * Палитры: градиент из нескольких опорных цветов, развернутый в таблицу на 256 цветов.
+ *
+ * Палитра хранит только опорные точки (до SAVA_PALETTE_STOPS), таблица RGB на 256
+ * индексов строится при первом обращении после изменения и дальше только читается:
+ * цвет по индексу - одно чтение таблицы, без интерполяции на каждый пиксель.
+ *
+ *   SavaPalette heat(SAVA_PALETTE_HEAT);     // 16 равномерных цветов
+ *   strip.fillPalette(0, 60, heat);          // Вся палитра на 60 пикселях
+ *   uint32_t c = heat.color(128);            // Цвет из середины палитры
+ */
+
+// --- Максимальное кол-во опорных цветов палитры ---
+#define SAVA_PALETTE_STOPS 16
+
+// Опорная точка градиента: индекс палитры 0..255 и цвет 0xRRGGBB в нем
+struct SavaGradientStop {
+    uint8_t  pos;
+    uint32_t color;
+};
+
+class SavaPalette {
+public:
+    SavaPalette();                                  // Радуга (SAVA_PALETTE_RAINBOW)
+    explicit SavaPalette(const uint32_t colors[16]);
+
+    // 16 цветов, равномерно разнесенных по индексам 0..255 (как CRGBPalette16)
+    void set16(const uint32_t colors[16]);
+    /**
+    * @brief Градиент по опорным точкам, отсортированным по pos (лишние сверх SAVA_PALETTE_STOPS отбрасываются).
+    *        До первой и после последней точки цвет не меняется.
+    */
+    void setGradient(const SavaGradientStop* stops, uint8_t count);
+
+    // Цвет 0xRRGGBB по индексу 0..255, с яркостью 0..255
+    uint32_t color(uint8_t index, uint8_t brightness = 255) const;
+    // Таблица 256 x {R, G, B} (строится при необходимости)
+    const uint8_t* lut() const;
+
+    /**
+    * @brief Плавный переход к палитре target: каждый канал таблицы сдвигается к цели не больше
+    *        чем на max_step. Вызывайте раз в кадр, пока возвращает true (переход идет).
+    *        После перехода палитра задается таблицей, опорные точки больше не используются.
+    */
+    bool fadeToward(const SavaPalette& target, uint8_t max_step = 4);
+    /**
+    * @brief Смесь двух палитр: amount = 0 - from, 255 - to. Для перехода, управляемого по времени.
+    */
+    void blend(const SavaPalette& from, const SavaPalette& to, uint8_t amount);
+
+private:
+    SavaGradientStop _stops[SAVA_PALETTE_STOPS];
+    uint8_t          _num_stops;
+    mutable uint8_t  _lut[256][3];
+    mutable bool     _lut_valid;
+
+    void _build() const;
+};
+
+// --- Готовые палитры: 16 равномерных цветов ---
+extern const uint32_t SAVA_PALETTE_RAINBOW[16];
+extern const uint32_t SAVA_PALETTE_HEAT[16];
+extern const uint32_t SAVA_PALETTE_OCEAN[16];
+extern const uint32_t SAVA_PALETTE_FOREST[16];
+
+#endif // SAVA_LED_PALETTE_H
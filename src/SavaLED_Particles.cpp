@@ -0,0 +1,164 @@
+#include "SavaLED_ESP32.h"
+
+// Затухание перед концом жизни
+static const uint16_t FADE_OUT_MS = 512;
+// Байт на частицу во всех массивах
+static const size_t PARTICLE_BYTES = 5 * sizeof(int32_t) + 2 * sizeof(int16_t);
+
+// Путь за us микросекунд при скорости vel (8.8 пикселей/с): vel * us / 1000000.
+// Целые секунды - умножением, остаток - через 4295 / 2^32 ~ 1 / 1000000 (как в SavaPhase)
+static inline int32_t particleTravel(int32_t vel, uint32_t us) {
+    return vel * (int32_t)(us / 1000000) + (int32_t)(((int64_t)vel * (us % 1000000) * 4295 + 0x80000000LL) >> 32);
+}
+
+SavaParticles::~SavaParticles() {
+    free(_block);
+}
+
+bool SavaParticles::begin(uint16_t capacity) {
+    free(_block);
+    _block = nullptr;
+    _capacity = _count = 0;
+    if (capacity == 0) return true;
+    void* block = calloc(capacity, PARTICLE_BYTES);
+    if (!block) return false;
+    _assign(block, capacity);
+    return true;
+}
+
+bool SavaParticles::reserve(uint16_t capacity) {
+    if (capacity <= _capacity) return true;
+    void* block = calloc(capacity, PARTICLE_BYTES);
+    if (!block) return false;
+    // Живые частицы - в начало новых массивов, поле за полем
+    void* old = _block;
+    const int32_t* pos = _pos;
+    const int32_t* origin = _origin;
+    const uint32_t* color = _color;
+    const int32_t* vel = _vel;
+    const uint32_t* age = _age;
+    const uint16_t* life = _life;
+    const uint16_t* fade_in = _fade_in;
+    _assign(block, capacity);
+    if (!old) return true;                  // Пула еще не было - копировать нечего
+    memcpy(_pos, pos, _count * sizeof(*_pos));
+    memcpy(_origin, origin, _count * sizeof(*_origin));
+    memcpy(_color, color, _count * sizeof(*_color));
+    memcpy(_vel, vel, _count * sizeof(*_vel));
+    memcpy(_age, age, _count * sizeof(*_age));
+    memcpy(_life, life, _count * sizeof(*_life));
+    memcpy(_fade_in, fade_in, _count * sizeof(*_fade_in));
+    free(old);
+    return true;
+}
+
+// Один блок на все поля: сначала 32-битные массивы, затем 16-битные (выравнивание сохраняется)
+void SavaParticles::_assign(void* block, uint16_t capacity) {
+    size_t n = capacity;
+    _block = block;
+    _pos = (int32_t*)block;
+    _origin = _pos + n;
+    _color = (uint32_t*)(_origin + n);
+    _vel = (int32_t*)(_color + n);
+    _age = (uint32_t*)(_vel + n);
+    _life = (uint16_t*)(_age + n);
+    _fade_in = _life + n;
+    _capacity = capacity;
+}
+
+int16_t SavaParticles::spawn(int32_t pos, int32_t vel, uint32_t color, uint16_t life_ms, uint16_t fade_in_ms) {
+    if (_count >= _capacity) return -1;
+    uint16_t i = _count++;
+    _pos[i] = pos;
+    _origin[i] = pos;
+    _vel[i] = vel;
+    _color[i] = color;
+    _age[i] = 0;
+    _life[i] = life_ms;
+    _fade_in[i] = fade_in_ms;
+    return i;
+}
+
+void SavaParticles::clear() {
+    _count = 0;
+}
+
+void SavaParticles::setTail(uint8_t length) {
+    _tail = length;
+    for (uint16_t j = 0; j < length; j++) {
+        _tail_lut[j] = 255 * (length - j) / length;
+    }
+}
+
+// Удаление без сдвига: на место i переносится последняя живая частица
+void SavaParticles::_kill(uint16_t i) {
+    uint16_t last = --_count;
+    if (i == last) return;
+    _pos[i] = _pos[last];
+    _origin[i] = _origin[last];
+    _vel[i] = _vel[last];
+    _color[i] = _color[last];
+    _age[i] = _age[last];
+    _life[i] = _life[last];
+    _fade_in[i] = _fade_in[last];
+}
+
+bool SavaParticles::update(const SavaTime& t, const SavaSegment& seg) {
+    bool changed = _count > 0;
+    // Частица погибает, когда вместе с хвостом полностью ушла за отрезок
+    const int32_t lo = -(int32_t)(_tail + 1) * SAVA_PX;
+    const int32_t hi = ((int32_t)seg.count + _tail + 1) * SAVA_PX;
+    for (uint16_t i = 0; i < _count; ) {
+        const uint32_t prev = _age[i];
+        const uint32_t age = prev + t.dt_us < prev ? UINT32_MAX : prev + t.dt_us;
+        _age[i] = age;
+        // Позиция - от точки появления по времени движения (после появления), а не суммой шагов:
+        // округление не копится, путь одинаков при любой частоте update()
+        const uint32_t appear_us = (uint32_t)_fade_in[i] * 1000;
+        if (age > appear_us) _pos[i] = _origin[i] + particleTravel(_vel[i], age - appear_us);
+        if ((_life[i] && age >= (uint32_t)_life[i] * 1000) || _pos[i] < lo || _pos[i] >= hi) {
+            _kill(i); // На место i встала другая частица - индекс не увеличиваем
+            continue;
+        }
+        i++;
+    }
+    return changed;
+}
+
+// Сглаженная точка: яркость делится между двумя соседними пикселями по дробной части позиции
+void SavaParticles::_plot(SavaLED_ESP32& strip, const SavaSegment& seg, int32_t pos, uint32_t color, uint8_t brightness) {
+    int32_t px = pos >> 8;
+    uint16_t frac = pos & 0xFF;
+    uint8_t b0 = (brightness * (256 - frac)) >> 8;
+    uint8_t b1 = (brightness * frac) >> 8;
+    for (uint8_t k = 0; k < 2; k++, px++) {
+        uint8_t b = k ? b1 : b0;
+        if (!b || px < 0 || px >= seg.count) continue;
+        strip._addPixel(seg.reversed ? seg.start + seg.count - 1 - px : seg.start + px, color, b);
+    }
+}
+
+void SavaParticles::draw(SavaLED_ESP32& strip, const SavaSegment& seg) {
+    strip.fillRange(seg.start, seg.count, background); // Рисуем фон
+
+    for (uint16_t i = 0; i < _count; i++) {
+        // Яркость головы: плавное появление, затем полная; затухание за FADE_OUT_MS до конца жизни
+        const uint32_t age_ms = _age[i] / 1000;
+        uint8_t b = 255;
+        if (age_ms < _fade_in[i]) b = age_ms * 255 / _fade_in[i];
+        if (_life[i] && _life[i] - age_ms < FADE_OUT_MS) b = (uint32_t)b * (_life[i] - age_ms) / FADE_OUT_MS;
+
+        int32_t pos = _pos[i];
+        _plot(strip, seg, pos, _color[i], b);
+
+        // Хвост: позади по направлению движения, не дальше точки появления
+        if (_age[i] <= (uint32_t)_fade_in[i] * 1000 || _vel[i] == 0) continue;
+        int32_t step = _vel[i] > 0 ? -SAVA_PX : SAVA_PX;
+        int32_t origin = _origin[i];
+        for (uint16_t j = 0; j < _tail; j++) {
+            pos += step;
+            if (step < 0 ? pos < origin : pos > origin) break;
+            _plot(strip, seg, pos, _color[i], (_tail_lut[j] * b) >> 8);
+        }
+    }
+}
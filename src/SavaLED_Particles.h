@@ -0,0 +1,83 @@
+#ifndef SAVA_LED_PARTICLES_H
+#define SAVA_LED_PARTICLES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Система частиц для одномерной ленты.
+ *
+ * Частицы хранятся "структурой массивов" (отдельный массив на каждое поле) в одном
+ * блоке памяти, который выделяется один раз в begin(). Живые частицы всегда лежат
+ * в начале массивов (0..count-1): погибшая частица заменяется последней, поэтому
+ * шаг и отрисовка стоят пропорционально числу живых частиц, а не емкости.
+ *
+ * Позиция - в фиксированной точке 8.8 (1 пиксель = SAVA_PX = 256), скорость - в пикселях
+ * в секунду в той же 8.8 (SAVA_PX = 1 пиксель/с). Позиция между пикселями рисуется сглаженно:
+ * яркость делится между двумя соседями. Возраст копится по времени с прошлого шага
+ * (SavaTime::dt_us), а позиция считается от точки появления по времени движения, поэтому
+ * путь, появление и время жизни не зависят от FPS и interval_ms.
+ */
+
+#define SAVA_PX 256
+
+class SavaParticles : public SavaEffect {
+public:
+    SavaParticles() {}
+    ~SavaParticles();
+    SavaParticles(const SavaParticles&) = delete;
+    SavaParticles& operator=(const SavaParticles&) = delete;
+
+    /**
+    * @brief Выделяет память под capacity частиц (повторный вызов - перевыделение, частицы удаляются).
+    * @return false, если не хватило памяти.
+    */
+    bool begin(uint16_t capacity);
+    /**
+    * @brief Увеличивает пул до capacity, живые частицы сохраняются (меньше текущей - ничего не делает).
+    * @return false, если не хватило памяти: пул остается прежним.
+    */
+    bool reserve(uint16_t capacity);
+    /**
+    * @brief Создает частицу.
+    * @param pos Позиция на отрезке, 8.8 (pixel * SAVA_PX).
+    * @param vel Скорость, пикселей в секунду в 8.8 (до ±32767 пикселей/с). Знак задает направление хвоста.
+    * @param color Цвет 0xRRGGBB.
+    * @param life_ms Время жизни, мс (0 - пока не улетит за отрезок).
+    * @param fade_in_ms Плавное появление на месте перед началом движения, мс.
+    * @return Индекс частицы или -1, если пул заполнен.
+    */
+    int16_t spawn(int32_t pos, int32_t vel, uint32_t color, uint16_t life_ms = 0, uint16_t fade_in_ms = 0);
+    void clear();
+    // Длина хвоста в пикселях (0..255). Спад яркости хвоста считается один раз здесь.
+    void setTail(uint8_t length);
+    uint16_t count() const { return _count; }
+    uint16_t capacity() const { return _capacity; }
+
+    bool update(const SavaTime& t, const SavaSegment& seg) override;
+    void draw(SavaLED_ESP32& strip, const SavaSegment& seg) override;
+
+    uint32_t background = 0;    // Цвет фона отрезка
+
+protected:
+    void _kill(uint16_t i);
+    void _assign(void* block, uint16_t capacity);
+    static void _plot(SavaLED_ESP32& strip, const SavaSegment& seg, int32_t pos, uint32_t color, uint8_t brightness);
+
+    uint16_t  _capacity = 0;
+    uint16_t  _count = 0;
+    void*     _block = nullptr;
+    // Поля частиц (структура массивов)
+    int32_t*  _pos = nullptr;
+    int32_t*  _origin = nullptr;    // Точка появления: хвост не рисуется дальше нее
+    uint32_t* _color = nullptr;
+    int32_t*  _vel = nullptr;       // 8.8 пикселей в секунду
+    uint32_t* _age = nullptr;       // мкс, с насыщением
+    uint16_t* _life = nullptr;      // мс
+    uint16_t* _fade_in = nullptr;   // мс
+
+    uint8_t   _tail = 0;
+    uint8_t   _tail_lut[255];       // Яркость i-го пикселя хвоста
+};
+
+#endif // SAVA_LED_PARTICLES_H
@@ -0,0 +1,271 @@
+#include "SavaLED_Stream.h"
+#include "lwip/sockets.h"
+
+// Идентификатор пакета ACN (E1.17) в корневом уровне E1.31
+static const uint8_t E131_ACN_ID[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+static const char ARTNET_ID[8] = "Art-Net";
+
+// Сколько пакетов одного сокета читать за poll(), чтобы поток не занял loop() целиком
+static const uint8_t POLL_MAX_PACKETS = 64;
+
+static inline uint16_t be16(const uint8_t* p) { return ((uint16_t)p[0] << 8) | p[1]; }
+static inline uint32_t be32(const uint8_t* p) { return ((uint32_t)be16(p) << 16) | be16(p + 2); }
+
+SavaStreamReceiver::~SavaStreamReceiver() {
+    end();
+}
+
+int SavaStreamReceiver::_openSocket(uint16_t port) {
+    int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s < 0) return -1;
+    int yes = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(s, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+bool SavaStreamReceiver::begin(const SavaStreamConfig& config) {
+    end();
+    if (!_strip._pixels) return false;
+    _cfg = config;
+    if (!_cfg.universe_channels) _cfg.universe_channels = 510;
+
+    // Сколько вселенных нужно, чтобы покрыть ленту от pixel_offset до конца
+    const uint16_t num_leds = _strip.getNumLeds();
+    _universes = 0;
+    if (_cfg.pixel_offset < num_leds) {
+        uint32_t channels = (uint32_t)(num_leds - _cfg.pixel_offset) * _strip._bpp;
+        uint32_t n = (channels + _cfg.universe_channels - 1) / _cfg.universe_channels;
+        _universes = n > SAVA_STREAM_MAX_UNIVERSES ? SAVA_STREAM_MAX_UNIVERSES : n;
+    }
+
+    static const uint16_t ports[3] = {SAVA_E131_PORT, SAVA_ARTNET_PORT, SAVA_DDP_PORT};
+    bool opened = false;
+    for (uint8_t i = 0; i < 3; i++) {
+        if (!(_cfg.protocols & (1 << i))) continue;
+        _sock[i] = _openSocket(ports[i]);
+        if (_sock[i] >= 0) opened = true;
+    }
+
+    // E1.31 multicast: вселенная N - группа 239.255.(N >> 8).(N & 0xFF)
+    if (_sock[0] >= 0 && _cfg.multicast) {
+        for (uint16_t u = 0; u < _universes; u++) {
+            struct ip_mreq mreq = {};
+            mreq.imr_multiaddr.s_addr = htonl(0xEFFF0000UL | (uint16_t)(_cfg.start_universe + u));
+            mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+            setsockopt(_sock[0], IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+        }
+    }
+    return opened;
+}
+
+void SavaStreamReceiver::end() {
+    for (uint8_t i = 0; i < 3; i++) {
+        if (_sock[i] >= 0) close(_sock[i]);
+        _sock[i] = -1;
+    }
+    _received = _seq_seen = 0;
+    _ddp_seq = 0;
+    _e131_sync = 0;
+    _artsync = false;
+    _frame_ready = _show_pending = false;
+}
+
+uint16_t SavaStreamReceiver::poll() {
+    static const SavaStreamProtocol protocols[3] = {SAVA_STREAM_E131, SAVA_STREAM_ARTNET, SAVA_STREAM_DDP};
+    uint16_t handled = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        if (_sock[i] < 0) continue;
+        for (uint8_t k = 0; k < POLL_MAX_PACKETS; k++) {
+            int len = recv(_sock[i], _rx, sizeof(_rx), MSG_DONTWAIT);
+            if (len <= 0) break;
+            handlePacket(protocols[i], _rx, len);
+            handled++;
+        }
+    }
+    // Кадр, собранный пока лента была занята, уходит при первой возможности
+    if (_show_pending && _strip.canShow()) {
+        _show_pending = false;
+        _strip.show();
+    }
+    return handled;
+}
+
+bool SavaStreamReceiver::frameReady() {
+    bool ready = _frame_ready;
+    _frame_ready = false;
+    return ready;
+}
+
+bool SavaStreamReceiver::handlePacket(SavaStreamProtocol protocol, const uint8_t* data, size_t len) {
+    bool ok = false;
+    if (data) {
+        switch (protocol) {
+            case SAVA_STREAM_E131:   ok = _handleE131(data, len); break;
+            case SAVA_STREAM_ARTNET: ok = _handleArtNet(data, len); break;
+            case SAVA_STREAM_DDP:    ok = _handleDDP(data, len); break;
+            default: break;
+        }
+    }
+    if (!ok) _stats.invalid++;
+    return ok;
+}
+
+// E1.31: корневой уровень ACN, уровень кадрирования и уровень DMP со значениями каналов
+bool SavaStreamReceiver::_handleE131(const uint8_t* p, size_t len) {
+    if (len < 49 || memcmp(p + 4, E131_ACN_ID, sizeof(E131_ACN_ID))) return false;
+    uint32_t root_vector = be32(p + 18);
+
+    // Пакет синхронизации: показываем кадр, если вселенные ждали именно этот адрес
+    if (root_vector == 0x00000008) {
+        if (be32(p + 40) != 0x00000001) return false;
+        if (_e131_sync && be16(p + 45) == _e131_sync) _frameDone();
+        return true;
+    }
+
+    if (root_vector != 0x00000004 || len < 126 || be32(p + 40) != 0x00000002) return false;
+    if (p[117] != 0x02 || p[118] != 0xA1) return false;
+    uint16_t count = be16(p + 123); // Вместе со стартовым кодом
+    if (count == 0 || 125 + (size_t)count > len) return false;
+
+    // Предпросмотр, завершение потока и не-DMX стартовый код (например, приоритеты 0xDD) не рисуем
+    if ((p[112] & 0xC0) || p[125] != 0) return true;
+
+    _e131_sync = be16(p + 109);
+    return _universeData(_cfg.start_universe, be16(p + 113), p[111], true, p + 126, count - 1, _e131_sync != 0);
+}
+
+// Art-Net: ArtDmx с данными вселенной и ArtSync; остальные коды операций пропускаются
+bool SavaStreamReceiver::_handleArtNet(const uint8_t* p, size_t len) {
+    if (len < 10 || memcmp(p, ARTNET_ID, sizeof(ARTNET_ID))) return false;
+    uint16_t op = p[8] | ((uint16_t)p[9] << 8);
+
+    uint32_t now = millis();
+    if (op == 0x5200) {
+        _artsync = true;
+        _artsync_ms = now;
+        _frameDone();
+        return true;
+    }
+    if (op != 0x5000) return true;
+    if (len < 18) return false;
+    uint16_t count = be16(p + 16);
+    if (18 + (size_t)count > len) return false;
+
+    // Без ArtSync больше 4 с источник считается несинхронным (как требует Art-Net 4)
+    if (_artsync && now - _artsync_ms > 4000) _artsync = false;
+    uint16_t universe = ((uint16_t)(p[15] & 0x7F) << 8) | p[14];
+    return _universeData(_cfg.artnet_start_universe, universe, p[12], p[12] != 0, p + 18, count, _artsync);
+}
+
+// DDP: данные адресуются смещением в байтах, кадр завершает флаг PUSH
+bool SavaStreamReceiver::_handleDDP(const uint8_t* p, size_t len) {
+    if (len < 10 || (p[0] & 0xC0) != 0x40) return false;
+    const uint8_t flags = p[0];
+    if (flags & 0x06) return true;                  // Запросы и ответы - не данные
+    if (p[3] != 1 && p[3] != 255) return true;      // Не устройство вывода по умолчанию
+    size_t header = (flags & 0x10) ? 14 : 10;       // С временной меткой
+    uint16_t count = be16(p + 8);
+    if (header + count > len) return false;
+
+    // 4-битный номер, 0 - не используется. Повтор или опоздание до 4 пакетов отбрасываются
+    uint8_t seq = p[1] & 0x0F;
+    if (seq) {
+        uint8_t d = (seq - _ddp_seq) & 0x0F;
+        if (_ddp_seq && (d == 0 || d >= 12)) {
+            _stats.out_of_order++;
+            return true;
+        }
+        _ddp_seq = seq;
+    }
+
+    if (count) {
+        _writeChannels(be32(p + 4), p + header, count);
+        _stats.packets++;
+    }
+    if (flags & 0x01) _frameDone();
+    return true;
+}
+
+// Номер последовательности E1.31 / Art-Net: отставание на 1..19 или повтор - пакет устарел
+bool SavaStreamReceiver::_seqNewer(uint8_t last, uint8_t seq) {
+    int8_t d = (int8_t)(seq - last);
+    return !(d <= 0 && d > -20);
+}
+
+// base - вселенная первого пикселя в нумерации протокола
+bool SavaStreamReceiver::_universeData(uint16_t base, uint16_t universe, uint8_t seq, bool check_seq, const uint8_t* data, uint16_t len, bool sync) {
+    if (universe < base || universe - base >= _universes) return false;
+    const uint16_t idx = universe - base;
+    const uint32_t bit = 1UL << idx;
+
+    if (check_seq) {
+        if ((_seq_seen & bit) && !_seqNewer(_seq[idx], seq)) {
+            _stats.out_of_order++;
+            return true;
+        }
+        _seq[idx] = seq;
+        _seq_seen |= bit;
+    }
+
+    // Вселенная повторилась раньше, чем пришли все: часть кадра потеряна, показываем что есть
+    if (!sync && (_received & bit)) _frameDone();
+
+    if (len > _cfg.universe_channels) len = _cfg.universe_channels;
+    _writeChannels((uint32_t)idx * _cfg.universe_channels, data, len);
+    _stats.packets++;
+    if (sync) return true;
+
+    _received |= bit;
+    const uint32_t all = _universes >= 32 ? UINT32_MAX : (1UL << _universes) - 1;
+    if (_received == all) _frameDone();
+    return true;
+}
+
+// Каналы потока (R, G, B[, W] подряд) -> буфер ленты в ее порядке байтов. channel - от pixel_offset
+void SavaStreamReceiver::_writeChannels(uint32_t channel, const uint8_t* data, uint32_t len) {
+    uint8_t* pixels = _strip._pixels;
+    const uint8_t bpp = _strip._bpp;
+    const uint32_t total = (uint32_t)_strip.getNumLeds() * bpp;
+    const uint32_t first = (uint32_t)_cfg.pixel_offset * bpp + channel;
+    if (!pixels || first >= total || len == 0) return;
+    if (len > total - first) len = total - first;
+
+    const SavaPixelFormat& f = _strip._fmt;
+    if (f.r == 0 && f.g == 1 && f.b == 2 && (bpp == 3 || f.w == 3)) {
+        memcpy(pixels + first, data, len); // Порядок совпадает с потоком
+    } else {
+        // Пакет может начинаться и заканчиваться посреди пикселя (DDP, границы вселенных)
+        const uint8_t order[4] = {f.r, f.g, f.b, f.w};
+        uint8_t c = first % bpp;
+        uint8_t* px = pixels + (first - c);
+        for (uint32_t i = 0; i < len; i++) {
+            px[order[c]] = data[i];
+            if (++c == bpp) {
+                c = 0;
+                px += bpp;
+            }
+        }
+    }
+    _strip._markDirty(first / bpp, (first + len + bpp - 1) / bpp);
+}
+
+void SavaStreamReceiver::_frameDone() {
+    _received = 0;
+    _stats.frames++;
+    _frame_ready = true;
+    if (!_cfg.auto_show) return;
+    if (_strip.canShow()) {
+        _show_pending = false;
+        _strip.show();
+    } else {
+        _show_pending = true;
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef SAVA_LED_STREAM_H
+#define SAVA_LED_STREAM_H
+
+#include "SavaLED_ESP32.h"
+
+/**
+ * Прием кадров по сети: E1.31 (sACN), Art-Net и DDP поверх UDP.
+ *
+ * Данные пакета копируются прямо в буфер ленты (с перестановкой каналов под порядок
+ * ленты, GRB и т.п.), без промежуточного кадра. Когда кадр собран - пришли все
+ * вселенные, пакет синхронизации (E1.31 sync, ArtSync) или DDP с флагом PUSH -
+ * вызывается show().
+ *
+ *   SavaStreamReceiver receiver(strip);
+ *   receiver.begin();              // После strip.begin() и подключения к сети
+ *   ...
+ *   void loop() { receiver.poll(); }
+ *
+ * Разбор пакетов не зависит от сокетов: handlePacket() принимает готовый пакет,
+ * поэтому поток можно подать и из другого источника (записанный дамп, свой транспорт).
+ * Рисуйте в режиме копирования (без setDoubleBuffer(true)): вселенные одного кадра
+ * приходят отдельными пакетами и дописываются в тот же буфер.
+ */
+
+// --- Стандартные порты ---
+#define SAVA_E131_PORT   5568
+#define SAVA_ARTNET_PORT 6454
+#define SAVA_DDP_PORT    4048
+
+// --- Максимальное кол-во вселенных в кадре (маска принятых вселенных - 32 бита) ---
+#define SAVA_STREAM_MAX_UNIVERSES 32
+
+// --- Протоколы (битовая маска для SavaStreamConfig::protocols) ---
+enum SavaStreamProtocol : uint8_t {
+    SAVA_STREAM_E131   = 0x01,
+    SAVA_STREAM_ARTNET = 0x02,
+    SAVA_STREAM_DDP    = 0x04,
+    SAVA_STREAM_ALL    = 0x07
+};
+
+// Настройки приема
+struct SavaStreamConfig {
+    uint8_t  protocols = SAVA_STREAM_ALL;
+    uint16_t start_universe = 1;        // E1.31: вселенная первого пикселя (нумерация с 1)
+    uint16_t artnet_start_universe = 0; // Art-Net: то же (Port-Address, нумерация с 0)
+    uint16_t universe_channels = 510;   // Каналов на вселенную: 510 = 170 RGB, 512 = 128 RGBW
+    uint16_t pixel_offset = 0;          // С какого светодиода ленты начинается поток
+    bool     multicast = false;         // E1.31: подписаться на группы 239.255.x.y своих вселенных
+    bool     auto_show = true;          // show() по завершении кадра (иначе - только frameReady())
+};
+
+// Счетчики приема
+struct SavaStreamStats {
+    uint32_t packets;       // Принятые пакеты с данными
+    uint32_t frames;        // Собранные кадры
+    uint32_t out_of_order;  // Отброшены по номеру последовательности (опоздавшие и повторы)
+    uint32_t invalid;       // Не разобраны: чужой протокол, битый заголовок, вселенная вне ленты
+};
+
+class SavaStreamReceiver {
+public:
+    explicit SavaStreamReceiver(SavaLED_ESP32& strip) : _strip(strip) {}
+    ~SavaStreamReceiver();
+    SavaStreamReceiver(const SavaStreamReceiver&) = delete;
+    SavaStreamReceiver& operator=(const SavaStreamReceiver&) = delete;
+
+    /**
+    * @brief Открывает UDP-порты выбранных протоколов. Вызывать после strip.begin()
+    *        и после подключения к сети (WiFi или Ethernet).
+    * @return false, если не удалось открыть ни один порт.
+    */
+    bool begin(const SavaStreamConfig& config = SavaStreamConfig());
+    void end();
+
+    /**
+    * @brief Читает все ожидающие пакеты (не блокирует). Вызывать в loop() как можно чаще.
+    * @return Кол-во обработанных пакетов.
+    */
+    uint16_t poll();
+
+    /**
+    * @brief Разбор одного пакета без сокета: данные - в буфер ленты, по концу кадра - show().
+    * @param protocol Один протокол (по порту, с которого пришел пакет).
+    * @return false, если пакет не разобран (считается в SavaStreamStats::invalid).
+    */
+    bool handlePacket(SavaStreamProtocol protocol, const uint8_t* data, size_t len);
+
+    // Кадр собран (сбрасывается при чтении). Для auto_show = false: show() вызывает приложение
+    bool frameReady();
+    const SavaStreamStats& getStats() const { return _stats; }
+    void resetStats() { _stats = {}; }
+
+private:
+    SavaLED_ESP32&   _strip;
+    SavaStreamConfig _cfg;
+    SavaStreamStats  _stats = {};
+    int      _sock[3] = {-1, -1, -1};   // E1.31, Art-Net, DDP
+    uint16_t _universes = 0;            // Сколько вселенных покрывает ленту (от start_universe)
+    uint32_t _received = 0;             // Маска вселенных, принятых в текущем кадре
+    uint32_t _seq_seen = 0;             // Маска вселенных, для которых известен номер последовательности
+    uint8_t  _seq[SAVA_STREAM_MAX_UNIVERSES];
+    uint8_t  _ddp_seq = 0;
+    uint16_t _e131_sync = 0;            // Адрес синхронизации E1.31 (0 - кадр по вселенным)
+    uint32_t _artsync_ms = 0;           // Время последнего ArtSync
+    bool     _artsync = false;          // Источник Art-Net шлет ArtSync - кадр только по нему
+    bool     _frame_ready = false;
+    bool     _show_pending = false;     // Кадр собран, но лента была занята
+    uint8_t  _rx[1472];                 // Один UDP-пакет (MTU Ethernet минус заголовки IP/UDP)
+
+    bool _handleE131(const uint8_t* p, size_t len);
+    bool _handleArtNet(const uint8_t* p, size_t len);
+    bool _handleDDP(const uint8_t* p, size_t len);
+    bool _universeData(uint16_t base, uint16_t universe, uint8_t seq, bool check_seq, const uint8_t* data, uint16_t len, bool sync);
+    static bool _seqNewer(uint8_t last, uint8_t seq);
+    void _writeChannels(uint32_t channel, const uint8_t* data, uint32_t len);
+    void _frameDone();
+    int  _openSocket(uint16_t port);
+};
+
+#endif // SAVA_LED_STREAM_H
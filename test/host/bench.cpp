@@ -0,0 +1,66 @@
+// Бенчмарк библиотеки на ПК: среднее время вызова основных функций на лентах
+// от 60 до 10000 светодиодов. Результат - CSV в stdout, для сравнения до и после изменений.
+//
+//   make bench && ./bench [итераций на замер]
+//
+// Каждая итерация - отдельный кадр: измеряемая функция, затем show() вне замера и шаг
+// часов на кадр 60 FPS. Так rainbowCycle() и runCometsEffect() работают в установившемся
+// режиме - со своим слотом состояния и шагом часов кадра, как в loop() на плате.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "SavaLED_ESP32.h"
+#include "host_stubs.h"
+
+static const uint16_t SIZES[] = {60, 144, 300, 1000, 3000, 10000};
+static const uint32_t PALETTE[] = {RED, GOLD, CYAN, BLUE};
+
+typedef std::chrono::steady_clock Clock;
+
+static int iterations = 200;
+
+// Среднее время fn() в микросекундах; after() выполняется после каждого вызова вне замера
+template <typename F, typename A>
+static double measure(F fn, A after) {
+    Clock::duration total = Clock::duration::zero();
+    for (int i = 0; i < iterations; i++) {
+        Clock::time_point t = Clock::now();
+        fn(i);
+        total += Clock::now() - t;
+        after(i);
+    }
+    return std::chrono::duration<double, std::micro>(total).count() / iterations;
+}
+
+static void benchmarkSize(uint16_t num_leds) {
+    SavaLED_ESP32 strip;
+    if (!strip.begin(num_leds, 14)) {
+        printf("%u,ошибка инициализации\n", num_leds);
+        return;
+    }
+    strip.setBrightness(128); // Яркость < 255: полный проход яркость+гамма в show()
+    auto nextFrame = [&](int) {
+        host_advance_time(1000000 / 60);
+        strip.show();
+    };
+    auto nothing = [](int) {};
+
+    double t_fill = measure([&](int i) { strip.fill(i & 1 ? ORANGE : TEAL); }, nothing);
+    double t_hsv = measure([&](int i) {
+        for (uint16_t n = 0; n < num_leds; n++) strip.setPixelHSV(n, n + i, 255, 255);
+    }, nothing);
+    double t_cycle = measure([&](int) { strip.rainbowCycle(255); }, nextFrame);
+    double t_static = measure([&](int i) { strip.rainbowStatic(0, num_leds, i & 1); }, nothing);
+    double t_comets = measure([&](int) { strip.runCometsEffect(5, 15, PALETTE, 4, BLACK, 0); }, nextFrame);
+    // Кадр меняется целиком перед каждым show(), чтобы подготовка не сводилась к измененному диапазону
+    double t_show = measure([&](int) { strip.show(); }, [&](int i) { strip.fill(i & 1 ? ORANGE : TEAL); });
+
+    printf("%u,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n", num_leds, t_show, t_fill, t_hsv, t_cycle, t_static, t_comets);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) iterations = atoi(argv[1]) > 0 ? atoi(argv[1]) : iterations;
+    printf("leds,show_us,fill_us,setPixelHSV_us,rainbowCycle_us,rainbowStatic_us,comets_us\n");
+    for (uint16_t size : SIZES) benchmarkSize(size);
+    return 0;
+}
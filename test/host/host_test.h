@@ -0,0 +1,27 @@
+#pragma once
+// Минимальные проверки для тестов на ПК: ошибка печатается с местом, тест продолжается,
+// код возврата main() - количество ошибок.
+#include <cstdio>
+#include "host_stubs.h"
+
+static int host_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: CHECK(%s)\n", __FILE__, __LINE__, #cond); \
+        host_failures++; \
+    } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long va_ = (long long)(a), vb_ = (long long)(b); \
+    if (va_ != vb_) { \
+        printf("%s:%d: CHECK_EQ(%s, %s): %lld != %lld\n", __FILE__, __LINE__, #a, #b, va_, vb_); \
+        host_failures++; \
+    } \
+} while (0)
+
+inline int hostTestResult() {
+    printf(host_failures ? "FAILED: %d\n" : "OK\n", host_failures);
+    return host_failures ? 1 : 0;
+}
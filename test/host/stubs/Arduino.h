@@ -0,0 +1,53 @@
+#pragma once
+// Минимальная замена Arduino.h для сборки библиотеки на ПК (Linux, g++/clang++)
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define PROGMEM
+
+typedef bool boolean;
+
+unsigned long millis();
+unsigned long micros();
+long random(long max);
+long random(long min, long max);
+inline uint32_t getCpuFrequencyMhz() { return 240; }
+
+inline long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+template <class T, class L, class H>
+inline T constrain(T x, L lo, H hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+class Print {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (n < size && write(buffer[n])) n++;
+        return n;
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    size_t readBytes(uint8_t* buffer, size_t length) {
+        size_t n = 0;
+        while (n < length) {
+            int c = read();
+            if (c < 0) break;
+            buffer[n++] = (uint8_t)c;
+        }
+        return n;
+    }
+    size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+};
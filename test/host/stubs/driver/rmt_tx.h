@@ -0,0 +1,101 @@
+#pragma once
+// Подмножество API RMT из ESP-IDF 5.x, которое использует библиотека.
+// Реализация - host_stubs.cpp: передача не идет никуда, данные кадра сохраняются для проверки.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+typedef struct rmt_channel_t* rmt_channel_handle_t;
+typedef struct rmt_encoder_t  rmt_encoder_t;
+typedef rmt_encoder_t*        rmt_encoder_handle_t;
+
+typedef enum {
+    RMT_CLK_SRC_DEFAULT = 4,
+    RMT_CLK_SRC_APB     = 4,
+    RMT_CLK_SRC_RC_FAST = 8,
+    RMT_CLK_SRC_XTAL    = 10
+} rmt_clock_source_t;
+
+typedef union {
+    struct {
+        uint16_t duration0 : 15;
+        uint16_t level0    : 1;
+        uint16_t duration1 : 15;
+        uint16_t level1    : 1;
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+typedef enum {
+    RMT_ENCODING_RESET    = 0,
+    RMT_ENCODING_COMPLETE = 1,
+    RMT_ENCODING_MEM_FULL = 2
+} rmt_encode_state_t;
+
+struct rmt_encoder_t {
+    size_t (*encode)(rmt_encoder_t* encoder, rmt_channel_handle_t channel, const void* data, size_t size, rmt_encode_state_t* state);
+    esp_err_t (*reset)(rmt_encoder_t* encoder);
+    esp_err_t (*del)(rmt_encoder_t* encoder);
+};
+
+typedef struct {
+    gpio_num_t         gpio_num;
+    rmt_clock_source_t clk_src;
+    uint32_t           resolution_hz;
+    size_t             mem_block_symbols;
+    size_t             trans_queue_depth;
+    int                intr_priority;
+    struct {
+        uint32_t invert_out   : 1;
+        uint32_t with_dma     : 1;
+        uint32_t io_loop_back : 1;
+        uint32_t io_od_mode   : 1;
+    } flags;
+} rmt_tx_channel_config_t;
+
+typedef struct {
+    rmt_symbol_word_t bit0, bit1;
+    struct { uint32_t msb_first : 1; } flags;
+} rmt_bytes_encoder_config_t;
+
+typedef struct { int dummy; } rmt_copy_encoder_config_t;
+
+typedef size_t (*rmt_encode_simple_cb_t)(const void* data, size_t data_size, size_t symbols_written, size_t symbols_free,
+                                         rmt_symbol_word_t* symbols, bool* done, void* arg);
+typedef struct {
+    rmt_encode_simple_cb_t callback;
+    void*                  arg;
+    size_t                 min_chunk_size;
+} rmt_simple_encoder_config_t;
+
+typedef struct {
+    int loop_count;
+    struct {
+        uint32_t eot_level         : 1;
+        uint32_t queue_nonblocking : 1;
+    } flags;
+} rmt_transmit_config_t;
+
+typedef struct { size_t num_symbols; } rmt_tx_done_event_data_t;
+typedef bool (*rmt_tx_done_callback_t)(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t* event, void* ctx);
+typedef struct { rmt_tx_done_callback_t on_trans_done; } rmt_tx_event_callbacks_t;
+
+#ifndef __containerof
+#define __containerof(ptr, type, member) ((type*)((char*)(ptr) - offsetof(type, member)))
+#endif
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t* config, rmt_channel_handle_t* channel);
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel);
+esp_err_t rmt_enable(rmt_channel_handle_t channel);
+esp_err_t rmt_disable(rmt_channel_handle_t channel);
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t channel, const rmt_tx_event_callbacks_t* cbs, void* ctx);
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t* config, rmt_encoder_handle_t* encoder);
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t* config, rmt_encoder_handle_t* encoder);
+esp_err_t rmt_new_simple_encoder(const rmt_simple_encoder_config_t* config, rmt_encoder_handle_t* encoder);
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder);
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder);
+esp_err_t rmt_transmit(rmt_channel_handle_t channel, rmt_encoder_handle_t encoder, const void* data, size_t size,
+                       const rmt_transmit_config_t* config);
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t channel, int timeout_ms);
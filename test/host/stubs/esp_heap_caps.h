@@ -0,0 +1,11 @@
+#pragma once
+#include <stdlib.h>
+#include <stdint.h>
+// Все области памяти на ПК - обычная куча
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+inline void* heap_caps_malloc(size_t size, uint32_t) { return malloc(size); }
+inline void* heap_caps_calloc(size_t n, size_t size, uint32_t) { return calloc(n, size); }
+inline void heap_caps_free(void* p) { free(p); }
@@ -0,0 +1,4 @@
+#pragma once
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+// Версия с rmt_new_simple_encoder(): собирается и энкодер с коррекцией
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(5, 3, 0)
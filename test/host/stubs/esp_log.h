@@ -0,0 +1,5 @@
+#pragma once
+#define ESP_LOGE(tag, ...) do { (void)(tag); } while (0)
+#define ESP_LOGW(tag, ...) do { (void)(tag); } while (0)
+#define ESP_LOGI(tag, ...) do { (void)(tag); } while (0)
+#define ESP_LOGD(tag, ...) do { (void)(tag); } while (0)
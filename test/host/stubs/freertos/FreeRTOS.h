@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdPASS  1
+#define pdFAIL  0
+#define portMAX_DELAY       0xFFFFFFFFu
+#define portTICK_PERIOD_MS  1
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define tskNO_AFFINITY      0x7FFFFFFF
+
+// Тесты однопоточные: критические секции ничего не делают
+typedef struct { int owner; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portMUX_INITIALIZE(mux)        (void)(mux)
+#define portENTER_CRITICAL(mux)        (void)(mux)
+#define portEXIT_CRITICAL(mux)         (void)(mux)
+#define portENTER_CRITICAL_ISR(mux)    (void)(mux)
+#define portEXIT_CRITICAL_ISR(mux)     (void)(mux)
+#define portENTER_CRITICAL_SAFE(mux)   (void)(mux)
+#define portEXIT_CRITICAL_SAFE(mux)    (void)(mux)
@@ -0,0 +1,13 @@
+#pragma once
+#include "FreeRTOS.h"
+
+// Счетный семафор без ожидания: Take без свободного места сразу возвращает pdFALSE
+typedef struct HostSemaphore { unsigned count, max; } *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial);
+BaseType_t  xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout);
+BaseType_t  xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t  xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* woken);
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem);
+void        vSemaphoreDelete(SemaphoreHandle_t sem);
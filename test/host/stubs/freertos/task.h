@@ -0,0 +1,15 @@
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// Задача не запускается: тесты вызывают функции отрисовки и show() сами
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+void       vTaskDelete(TaskHandle_t task);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+TickType_t xTaskGetTickCount();
+BaseType_t xTaskDelayUntil(TickType_t* previous, TickType_t period);
+void       vTaskDelay(TickType_t ticks);
+void       ulTaskNotifyTake(BaseType_t clear, TickType_t timeout);
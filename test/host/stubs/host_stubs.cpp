@@ -0,0 +1,185 @@
+// Заглушки Arduino, FreeRTOS и драйвера RMT для сборки библиотеки на ПК
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include "Arduino.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "host_stubs.h"
+
+// --- Время ---
+static const auto start_time = std::chrono::steady_clock::now();
+static uint64_t time_offset_us = 0;
+
+void host_advance_time(uint32_t us) { time_offset_us += us; }
+
+unsigned long micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count() + time_offset_us;
+}
+unsigned long millis() { return micros() / 1000; }
+uint32_t esp_cpu_get_cycle_count() { return micros() * 240; }
+int64_t esp_timer_get_time() { return micros(); }
+
+long random(long max) { return max > 0 ? rand() % max : 0; }
+long random(long min, long max) { return max > min ? min + rand() % (max - min) : min; }
+
+// --- FreeRTOS ---
+SemaphoreHandle_t xSemaphoreCreateBinary() { return new HostSemaphore{0, 1}; }
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) { return new HostSemaphore{initial, max}; }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t) {
+    if (!sem->count) return pdFALSE;
+    sem->count--;
+    return pdTRUE;
+}
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    if (sem->count >= sem->max) return pdFALSE;
+    sem->count++;
+    return pdTRUE;
+}
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+    return xSemaphoreGive(sem);
+}
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem) { return sem->count; }
+void vSemaphoreDelete(SemaphoreHandle_t sem) { delete sem; }
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    if (handle) *handle = (void*)1;
+    return pdPASS;
+}
+void vTaskDelete(TaskHandle_t) {}
+TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+TickType_t xTaskGetTickCount() { return millis(); }
+BaseType_t xTaskDelayUntil(TickType_t* previous, TickType_t period) {
+    *previous += period;
+    return pdTRUE;
+}
+void vTaskDelay(TickType_t) {}
+void ulTaskNotifyTake(BaseType_t, TickType_t) {}
+
+// --- RMT ---
+struct rmt_channel_t {
+    rmt_tx_done_callback_t on_done = nullptr;
+    void*                  ctx = nullptr;
+};
+
+// Энкодеры драйвера; энкодеры библиотеки (свой rmt_encoder_t) в этот список не попадают
+enum HostEncoderKind { HOST_BYTES, HOST_COPY, HOST_SIMPLE };
+struct HostEncoder : rmt_encoder_t {
+    HostEncoderKind             kind;
+    rmt_simple_encoder_config_t simple;
+};
+static std::set<rmt_encoder_handle_t> driver_encoders;
+
+std::vector<uint8_t>  host_tx_bytes;
+std::vector<uint32_t> host_tx_symbols;
+int    host_tx_count = 0;
+bool   host_tx_auto_done = true;
+size_t host_simple_chunk = 48;
+static std::vector<rmt_channel_handle_t> pending;
+
+static size_t bytes_encode(rmt_encoder_t*, rmt_channel_handle_t, const void* data, size_t size, rmt_encode_state_t* state) {
+    host_tx_bytes.assign((const uint8_t*)data, (const uint8_t*)data + size);
+    *state = RMT_ENCODING_COMPLETE;
+    return size * 8;
+}
+static size_t copy_encode(rmt_encoder_t*, rmt_channel_handle_t, const void*, size_t size, rmt_encode_state_t* state) {
+    *state = RMT_ENCODING_COMPLETE;
+    return size / sizeof(rmt_symbol_word_t);
+}
+
+static HostEncoder* new_encoder(HostEncoderKind kind) {
+    HostEncoder* e = new HostEncoder();
+    e->kind = kind;
+    if (kind == HOST_BYTES) e->encode = bytes_encode;
+    if (kind == HOST_COPY) e->encode = copy_encode;
+    driver_encoders.insert(e);
+    return e;
+}
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t*, rmt_channel_handle_t* channel) {
+    *channel = new rmt_channel_t();
+    return ESP_OK;
+}
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel) {
+    delete channel;
+    return ESP_OK;
+}
+esp_err_t rmt_enable(rmt_channel_handle_t) { return ESP_OK; }
+esp_err_t rmt_disable(rmt_channel_handle_t) { return ESP_OK; }
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t channel, const rmt_tx_event_callbacks_t* cbs, void* ctx) {
+    channel->on_done = cbs->on_trans_done;
+    channel->ctx = ctx;
+    return ESP_OK;
+}
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t*, rmt_encoder_handle_t* encoder) {
+    *encoder = new_encoder(HOST_BYTES);
+    return ESP_OK;
+}
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t*, rmt_encoder_handle_t* encoder) {
+    *encoder = new_encoder(HOST_COPY);
+    return ESP_OK;
+}
+esp_err_t rmt_new_simple_encoder(const rmt_simple_encoder_config_t* config, rmt_encoder_handle_t* encoder) {
+    HostEncoder* e = new_encoder(HOST_SIMPLE);
+    e->simple = *config;
+    *encoder = e;
+    return ESP_OK;
+}
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder) {
+    if (driver_encoders.erase(encoder)) {
+        delete (HostEncoder*)encoder;
+        return ESP_OK;
+    }
+    return encoder->del(encoder);
+}
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t) { return ESP_OK; }
+
+static void complete(rmt_channel_handle_t channel) {
+    rmt_tx_done_event_data_t event = {0};
+    if (channel->on_done) channel->on_done(channel, &event, channel->ctx);
+}
+
+void host_tx_complete_all() {
+    std::vector<rmt_channel_handle_t> done;
+    done.swap(pending);
+    for (rmt_channel_handle_t channel : done) complete(channel);
+}
+
+// Кадр кодируется сразу: простой энкодер вызывается кусками по host_simple_chunk символов,
+// как драйвер заполняет память канала
+esp_err_t rmt_transmit(rmt_channel_handle_t channel, rmt_encoder_handle_t encoder, const void* data, size_t size,
+                       const rmt_transmit_config_t*) {
+    host_tx_count++;
+    if (!driver_encoders.count(encoder)) {
+        rmt_encode_state_t state = RMT_ENCODING_RESET;
+        encoder->encode(encoder, channel, data, size, &state);
+        if (!(state & RMT_ENCODING_COMPLETE)) abort();
+    } else {
+        HostEncoder* e = (HostEncoder*)encoder;
+        if (e->kind == HOST_BYTES) {
+            host_tx_bytes.assign((const uint8_t*)data, (const uint8_t*)data + size);
+        } else if (e->kind == HOST_SIMPLE) {
+            host_tx_symbols.clear();
+            std::vector<rmt_symbol_word_t> chunk(host_simple_chunk);
+            bool done = false;
+            size_t written = 0;
+            while (!done) {
+                size_t n = e->simple.callback(data, size, written, chunk.size(), chunk.data(), &done, e->simple.arg);
+                if (n == 0 && !done) {
+                    fprintf(stderr, "rmt_transmit: простой энкодер не записал ни одного символа\n");
+                    abort();
+                }
+                for (size_t i = 0; i < n; i++) host_tx_symbols.push_back(chunk[i].val);
+                written += n;
+            }
+        }
+    }
+    if (host_tx_auto_done) complete(channel);
+    else pending.push_back(channel);
+    return ESP_OK;
+}
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t, int) { return ESP_OK; }
@@ -0,0 +1,21 @@
+#pragma once
+// Состояние заглушек для проверок в тестах
+#include <stdint.h>
+#include <vector>
+#include "driver/rmt_tx.h"
+
+// Сдвигает micros()/millis() вперед: кадры с заданным шагом без ожидания
+void host_advance_time(uint32_t us);
+
+// Байты последнего кадра, переданного через rmt_new_bytes_encoder()
+extern std::vector<uint8_t>  host_tx_bytes;
+// RMT-символы последнего кадра, переданного через rmt_new_simple_encoder()
+extern std::vector<uint32_t> host_tx_symbols;
+// Количество вызовов rmt_transmit()
+extern int host_tx_count;
+// true - передача завершается сразу внутри rmt_transmit(), false - ждет host_tx_complete_all()
+extern bool host_tx_auto_done;
+// Завершает все отложенные передачи (вызывает колбэки on_trans_done)
+void host_tx_complete_all();
+// Символов в одном вызове колбэка простого энкодера (как mem_block_symbols на железе)
+extern size_t host_simple_chunk;
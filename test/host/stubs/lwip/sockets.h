@@ -0,0 +1,6 @@
+#pragma once
+// lwIP повторяет BSD-сокеты, на ПК - системные
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
@@ -0,0 +1,239 @@
+// Записанные анимации: кадры ленты -> SavaAnimRecorder (SKIP/LITERAL/REPEAT) -> SavaAnimPlayer,
+// распакованный буфер сверяется с исходным кадр за кадром.
+#include <vector>
+#include <cstring>
+#include "SavaLED_Animation.h"
+#include "host_test.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+// Поток в памяти: запись в конец, чтение с начала
+class MemoryStream : public Stream {
+public:
+    Bytes data;
+    size_t pos = 0;
+    size_t write(uint8_t c) override { data.push_back(c); return 1; }
+    int available() override { return data.size() - pos; }
+    int read() override { return pos < data.size() ? data[pos++] : -1; }
+    int peek() override { return pos < data.size() ? data[pos] : -1; }
+};
+
+static uint32_t rng = 12345;
+static uint8_t nextRandom() {
+    rng = rng * 1103515245 + 12345;
+    return rng >> 16;
+}
+
+// Кадр со всеми видами команд: неизменный фон, одноцветные отрезки длиннее 64 пикселей
+// (несколько команд подряд), одиночные пиксели и повторы из двух
+static void drawFrame(uint8_t* px, uint16_t n, uint8_t bpp, uint16_t k) {
+    if (k == 0) {
+        for (uint32_t i = 0; i < (uint32_t)n * bpp; i++) px[i] = nextRandom();
+        return;
+    }
+    const uint16_t run = (k * 37) % n;
+    for (uint16_t i = run; i < run + 100 && i < n; i++) memset(px + i * bpp, k, bpp);
+    for (uint16_t j = 0; j < 20; j++) {
+        uint16_t i = (k * 101 + j * 13) % n;
+        for (uint8_t c = 0; c < bpp; c++) px[i * bpp + c] = nextRandom();
+    }
+    if (k % 3 == 0) memcpy(px + (n - 1) * bpp, px + (n - 2) * bpp, bpp);
+}
+
+static void testRoundTrip(const SavaPixelFormat& format, bool from_stream) {
+    const uint16_t n = 300;
+    const uint16_t frames = 40;
+    SavaLEDConfig config;
+    config.format = format;
+    SavaLED_ESP32 source;
+    CHECK(source.begin(n, 5, config));
+
+    MemoryStream file;
+    SavaAnimRecorder recorder;
+    CHECK(recorder.begin(file, source, 1000000 / 60));
+    std::vector<Bytes> expected;
+    for (uint16_t k = 0; k < frames; k++) {
+        drawFrame(source.getPixels(), n, format.bpp, k);
+        CHECK(recorder.addFrame(source));
+        expected.push_back(Bytes(source.getPixels(), source.getPixels() + n * format.bpp));
+    }
+    recorder.end();
+    CHECK_EQ(recorder.frames(), frames);
+    CHECK_EQ(recorder.bytesWritten(), file.data.size());
+    CHECK(file.data.size() < (size_t)frames * n * format.bpp / 2); // Кадры после первого сжаты
+
+    SavaLED_ESP32 target;
+    CHECK(target.begin(n, 6, config));
+    SavaAnimPlayer player(target);
+    CHECK(from_stream ? player.begin(file) : player.begin(file.data.data(), file.data.size()));
+    for (uint16_t k = 0; k < frames; k++) {
+        CHECK(player.nextFrame());
+        CHECK(!memcmp(target.getPixels(), expected[k].data(), expected[k].size()));
+    }
+    CHECK(!player.nextFrame());
+    CHECK(player.finished());
+    CHECK_EQ(player.frameIndex(), frames);
+}
+
+// Запись в RGB, проигрывание на ленте GRB со смещением: байты переставляются, соседи не задеты
+static void testReorder() {
+    const uint16_t n = 4;
+    const uint8_t frame[n * 3] = {0x10, 0x20, 0x30, 0x11, 0x21, 0x31, 0x11, 0x21, 0x31, 0x12, 0x22, 0x32};
+    MemoryStream file;
+    SavaAnimRecorder recorder;
+    CHECK(recorder.begin(file, n, SAVA_RGB, 1000));
+    CHECK(recorder.addFrame(frame));
+    recorder.end();
+
+    SavaLED_ESP32 strip;
+    CHECK(strip.begin(10, 5));
+    SavaAnimPlayer player(strip);
+    CHECK(player.begin(file.data.data(), file.data.size(), 3));
+    CHECK(player.nextFrame());
+    const uint8_t* px = strip.getPixels();
+    for (uint16_t i = 0; i < n; i++) {
+        CHECK_EQ(px[(3 + i) * 3 + 0], frame[i * 3 + 1]);
+        CHECK_EQ(px[(3 + i) * 3 + 1], frame[i * 3 + 0]);
+        CHECK_EQ(px[(3 + i) * 3 + 2], frame[i * 3 + 2]);
+    }
+    CHECK_EQ(px[2 * 3], 0);
+    CHECK_EQ(px[7 * 3], 0);
+
+    // Анимация не помещается на ленту со смещения
+    CHECK(!player.begin(file.data.data(), file.data.size(), 7));
+}
+
+// Обрезанные данные: кадр не распаковывается, проигрывание заканчивается
+static void testTruncated() {
+    const uint16_t n = 8;
+    uint8_t frame[n * 3];
+    for (uint8_t i = 0; i < sizeof(frame); i++) frame[i] = i;
+    MemoryStream file;
+    SavaAnimRecorder recorder;
+    CHECK(recorder.begin(file, n, SAVA_GRB, 1000));
+    CHECK(recorder.addFrame(frame));
+    recorder.end();
+
+    SavaLED_ESP32 strip;
+    CHECK(strip.begin(n, 5));
+    SavaAnimPlayer player(strip);
+    CHECK(!player.begin(file.data.data(), SAVA_ANIM_HEADER - 1));
+    CHECK(player.begin(file.data.data(), file.data.size() - 5));
+    CHECK(!player.nextFrame());
+    CHECK(player.finished());
+}
+
+// Битые положения каналов в заголовке: вне пикселя или повтор - файл не принимается
+static void testBadHeader() {
+    const uint16_t n = 2;
+    const uint8_t frame[n * 3] = {1, 2, 3, 4, 5, 6};
+    MemoryStream file;
+    SavaAnimRecorder recorder;
+    CHECK(recorder.begin(file, n, SAVA_RGB, 1000));
+    CHECK(recorder.addFrame(frame));
+    recorder.end();
+
+    SavaLED_ESP32 strip;
+    CHECK(strip.begin(n, 5));
+    SavaAnimPlayer player(strip);
+    CHECK(player.begin(file.data.data(), file.data.size()));
+
+    Bytes bad = file.data;
+    bad[7] = bad[6];                        // G на месте R
+    CHECK(!player.begin(bad.data(), bad.size()));
+    CHECK(player.finished());
+    bad = file.data;
+    bad[8] = 3;                             // B за пределами 3-байтного пикселя
+    CHECK(!player.begin(bad.data(), bad.size()));
+    bad = file.data;
+    bad[6] = 7;
+    CHECK(!player.begin(bad.data(), bad.size()));
+
+    // W в 3-байтном формате не используется и не проверяется
+    bad = file.data;
+    bad[9] = 0xFF;
+    CHECK(player.begin(bad.data(), bad.size()));
+    CHECK(player.nextFrame());
+    const uint8_t expected[n * 3] = {2, 1, 3, 5, 4, 6};   // RGB файла -> GRB ленты
+    CHECK(!memcmp(strip.getPixels(), expected, sizeof(expected)));
+
+    // 4-байтный формат: W должен занять оставшийся байт
+    MemoryStream file4;
+    const uint8_t frame4[4] = {1, 2, 3, 4};
+    CHECK(recorder.begin(file4, 1, SAVA_RGBW, 1000));
+    CHECK(recorder.addFrame(frame4));
+    recorder.end();
+    SavaLEDConfig config;
+    config.format = SAVA_GRBW;
+    SavaLED_ESP32 strip4;
+    CHECK(strip4.begin(1, 6, config));
+    SavaAnimPlayer player4(strip4);
+    CHECK(player4.begin(file4.data.data(), file4.data.size()));
+    bad = file4.data;
+    bad[9] = 2;                             // W на месте B
+    CHECK(!player4.begin(bad.data(), bad.size()));
+}
+
+// Запись не помечает ленту измененной: неизменный кадр пропускается setSkipUnchanged()
+static void testRecorderKeepsClean() {
+    SavaLED_ESP32 strip;
+    strip.setSkipUnchanged(true);
+    CHECK(strip.begin(16, 5));
+    strip.fill(0x102030);
+    strip.show();
+
+    MemoryStream file;
+    SavaAnimRecorder recorder;
+    CHECK(recorder.begin(file, strip, 1000));
+    int sent = host_tx_count;
+    CHECK(recorder.addFrame(strip));
+    strip.show();
+    CHECK_EQ(host_tx_count, sent);
+}
+
+// update() идет по часам кадра ленты: без show() время не двигается
+static void testFrameClock() {
+    const uint16_t n = 4;
+    uint8_t frame[n * 3] = {};
+    MemoryStream file;
+    SavaAnimRecorder recorder;
+    CHECK(recorder.begin(file, n, SAVA_GRB, 10000));
+    for (uint8_t k = 0; k < 3; k++) {
+        frame[0] = k;
+        CHECK(recorder.addFrame(frame));
+    }
+    recorder.end();
+
+    SavaLED_ESP32 strip;
+    CHECK(strip.begin(n, 5));
+    SavaAnimPlayer player(strip);
+    CHECK(player.begin(file.data.data(), file.data.size()));
+    CHECK(player.update());                 // Первый кадр - сразу
+    strip.show();
+    host_advance_time(20000);
+    CHECK(!player.update());                // micros() ушли вперед, часы кадра - нет
+    strip.show();
+    CHECK(player.update());
+    CHECK_EQ(player.frameIndex(), 2);
+    CHECK(!player.update());
+    host_advance_time(9000);
+    strip.show();
+    CHECK(!player.update());
+    host_advance_time(1000);
+    strip.show();
+    CHECK(player.update());
+    CHECK_EQ(strip.getPixels()[0], 2);
+}
+
+int main() {
+    testRoundTrip(SAVA_GRB, false);
+    testRoundTrip(SAVA_GRB, true);
+    testRoundTrip(SAVA_GRBW, false);
+    testRoundTrip(SAVA_GRBW, true);
+    testReorder();
+    testTruncated();
+    testBadHeader();
+    testRecorderKeepsClean();
+    testFrameClock();
+    return hostTestResult();
+}
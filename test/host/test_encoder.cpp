@@ -0,0 +1,110 @@
+// Энкодер с коррекцией "на лету" (setEncoderCorrection): поток RMT-символов сверяется
+// с записанным эталоном и с байтами, которые готовит show() в режиме копирования.
+#include <vector>
+#include "SavaLED_ESP32.h"
+#include "host_test.h"
+
+// Символы WS2812B при 10 МГц: 0 - 400/800 нс, 1 - 800/400 нс, сброс 280 мкс двумя половинами
+static const uint32_t B0 = 0x00088004;
+static const uint32_t B1 = 0x00048008;
+static const uint32_t RST = 0x05780578;
+
+// Поток символов -> байты (старший бит первым), последний символ - сброс
+static std::vector<uint8_t> decode(const std::vector<uint32_t>& symbols) {
+    std::vector<uint8_t> bytes;
+    for (size_t i = 0; i + 8 <= symbols.size(); i += 8) {
+        uint8_t v = 0;
+        for (size_t k = 0; k < 8; k++) v = (v << 1) | (symbols[i + k] == B1);
+        bytes.push_back(v);
+    }
+    return bytes;
+}
+
+// Записанный поток двух светодиодов без коррекции: красный и синий с яркостью 1
+static void testRecordedStream() {
+    static const uint32_t expected[] = {
+        B0, B0, B0, B0, B0, B0, B0, B0,     // G = 0x00
+        B1, B1, B1, B1, B1, B1, B1, B1,     // R = 0xFF
+        B0, B0, B0, B0, B0, B0, B0, B0,     // B = 0x00
+        B0, B0, B0, B0, B0, B0, B0, B0,     // G = 0x00
+        B0, B0, B0, B0, B0, B0, B0, B0,     // R = 0x00
+        B0, B0, B0, B0, B0, B0, B0, B1,     // B = 0x01
+        RST
+    };
+    for (size_t chunk : {8, 9, 13, 48}) {
+        host_simple_chunk = chunk; // Кадр кодируется кусками, колбэк продолжает с середины
+        SavaLED_ESP32 strip;
+        strip.setEncoderCorrection(true);
+        CHECK(strip.begin(2, 5));
+        strip.setGammaCorrection(false);
+        strip.setPixel(0, 0xFF0000);
+        strip.setPixel(1, 0x000001);
+        strip.show();
+        CHECK_EQ(host_tx_symbols.size(), sizeof(expected) / sizeof(expected[0]));
+        bool same = host_tx_symbols.size() == sizeof(expected) / sizeof(expected[0]);
+        for (size_t i = 0; same && i < host_tx_symbols.size(); i++) same = host_tx_symbols[i] == expected[i];
+        CHECK(same);
+    }
+    host_simple_chunk = 48;
+}
+
+// Коррекция в энкодере дает те же байты, что подготовка в show() в режиме копирования
+static void compareWithCopyMode(const SavaPixelFormat& format, bool per_channel) {
+    const uint16_t n = 50;
+    SavaLEDConfig config;
+    config.format = format;
+    SavaLED_ESP32 copy, encoder;
+    encoder.setEncoderCorrection(true);
+    CHECK(copy.begin(n, 5, config));
+    CHECK(encoder.begin(n, 6, config));
+    for (SavaLED_ESP32* s : {&copy, &encoder}) {
+        s->setBrightness(100);
+        if (per_channel) s->setColorCorrection(255, 176, 240, 200);
+        for (uint16_t i = 0; i < n; i++) s->setPixelHSV(i, i * 5, 255, 255);
+    }
+    copy.show();
+    std::vector<uint8_t> reference = host_tx_bytes;
+    host_simple_chunk = 13;
+    encoder.show();
+    host_simple_chunk = 48;
+    CHECK_EQ(host_tx_symbols.back(), RST);
+    CHECK(decode(host_tx_symbols) == reference);
+    CHECK_EQ(reference.size(), (size_t)n * format.bpp);
+}
+
+// Смена яркости, пока кадры в очереди: таблица, которую читает энкодер, не переписывается,
+// новая яркость идет с первого кадра, для которого нашлась свободная копия таблицы
+static void testLutSwapBetweenFrames() {
+    SavaLEDConfig config;
+    config.pipeline_depth = 3;
+    SavaLED_ESP32 strip;
+    strip.setEncoderCorrection(true);
+    CHECK(strip.begin(1, 5, config));
+    strip.setGammaCorrection(false);
+    host_tx_auto_done = false;
+
+    auto frame = [&](uint8_t brightness) {
+        strip.setBrightness(brightness);
+        strip.setPixel(0, 0xFFFFFF);
+        strip.show();
+        std::vector<uint8_t> bytes = decode(host_tx_symbols);
+        return bytes.empty() ? -1 : bytes[0];
+    };
+    CHECK_EQ(frame(255), 255);              // Копия 0
+    CHECK_EQ(frame(128), 127);              // Копия 1 свободна
+    CHECK_EQ(frame(64), 127);               // Копия 0 занята первым кадром - старая таблица
+    CHECK(!strip.canShow());
+    host_tx_complete_all();
+    CHECK_EQ(frame(64), 63);                // Очередь пуста - изменение применилось
+    host_tx_complete_all();
+    host_tx_auto_done = true;
+}
+
+int main() {
+    testRecordedStream();
+    compareWithCopyMode(SAVA_GRB, false);
+    compareWithCopyMode(SAVA_GRB, true);
+    compareWithCopyMode(SAVA_GRBW, true);
+    testLutSwapBetweenFrames();
+    return hostTestResult();
+}
@@ -0,0 +1,137 @@
+// Ядра SWAR (SavaLED_Kernels.h) побитово совпадают с побайтовыми вариантами:
+// пословные операции - на всем пространстве входов, буферные - при любом выравнивании и длине.
+#include <cstdlib>
+#include <cstring>
+#include "SavaLED_Kernels.h"
+#include "host_test.h"
+
+#if !SAVA_KERNELS_SWAR
+#error "test_kernels сравнивает SWAR с побайтовым вариантом: соберите с SAVA_KERNELS_SWAR=1"
+#endif
+
+static uint32_t pack(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3) {
+    uint32_t w;
+    const uint8_t b[4] = {b0, b1, b2, b3};
+    memcpy(&w, b, 4);
+    return w;
+}
+
+// Четыре полосы слова - четыре разных пары (a, b), чтобы соседние байты были разными
+static void lanes(uint8_t a, uint8_t b, uint8_t x[4], uint8_t y[4]) {
+    x[0] = a;       y[0] = b;
+    x[1] = b;       y[1] = a;
+    x[2] = 255 - a; y[2] = b;
+    x[3] = a ^ 0x5A; y[3] = 255 - b;
+}
+
+static void testWordsExhaustive() {
+    int scale_bad = 0, add_bad = 0, blend_bad = 0;
+    for (uint32_t w = 0; w <= 256; w++) {
+        for (uint32_t a = 0; a < 256; a++) {
+            uint8_t x[4] = {(uint8_t)a, (uint8_t)(a + 85), (uint8_t)(a + 170), (uint8_t)~a}, ref[4];
+            memcpy(ref, x, 4);
+            savaScaleScalar(ref, 4, w);
+            uint32_t got = savaScaleWord(pack(x[0], x[1], x[2], x[3]), w);
+            if (memcmp(&got, ref, 4)) scale_bad++;
+        }
+    }
+    for (uint32_t a = 0; a < 256; a++) {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint8_t x[4], y[4], ref[4];
+            lanes(a, b, x, y);
+            memcpy(ref, x, 4);
+            savaAddSatScalar(ref, y, 4);
+            uint32_t got = savaAddSatWord(pack(x[0], x[1], x[2], x[3]), pack(y[0], y[1], y[2], y[3]));
+            if (memcmp(&got, ref, 4)) add_bad++;
+            for (uint32_t w = 0; w <= 256; w++) {
+                memcpy(ref, x, 4);
+                savaBlendScalar(ref, y, 4, w);
+                got = savaBlendWord(pack(x[0], x[1], x[2], x[3]), pack(y[0], y[1], y[2], y[3]), w);
+                if (memcmp(&got, ref, 4)) blend_bad++;
+            }
+        }
+    }
+    CHECK_EQ(scale_bad, 0);
+    CHECK_EQ(add_bad, 0);
+    CHECK_EQ(blend_bad, 0);
+}
+
+// Буферные функции: голова и хвост побайтово, середина словами, разное выравнивание буферов
+static void testBuffers() {
+    const size_t MAX = 67;
+    alignas(4) uint8_t a[MAX + 8], b[MAX + 8], c[MAX + 8], ref[MAX + 8], out[MAX + 8];
+    srand(1);
+    int bad = 0;
+    for (int round = 0; round < 200; round++) {
+        for (size_t i = 0; i < sizeof(a); i++) {
+            a[i] = rand();
+            b[i] = rand();
+            c[i] = rand();
+        }
+        uint16_t w = rand() % 257;
+        for (size_t len = 0; len <= MAX; len++) {
+            for (size_t da = 0; da < 4; da++) {
+                for (size_t sa = 0; sa < 4; sa++) {
+                    memcpy(ref, a, sizeof(a));
+                    memcpy(out, a, sizeof(a));
+                    savaScaleScalar(ref + da, len, w);
+                    savaScale(out + da, len, w);
+                    bad += memcmp(ref, out, sizeof(a)) != 0;
+
+                    memcpy(ref, a, sizeof(a));
+                    memcpy(out, a, sizeof(a));
+                    savaAddSatScalar(ref + da, b + sa, len);
+                    savaAddSat(out + da, b + sa, len);
+                    bad += memcmp(ref, out, sizeof(a)) != 0;
+
+                    memcpy(ref, a, sizeof(a));
+                    memcpy(out, a, sizeof(a));
+                    savaBlendScalar(ref + da, b + sa, len, w);
+                    savaBlend(out + da, b + sa, len, w);
+                    bad += memcmp(ref, out, sizeof(a)) != 0;
+
+                    memcpy(ref, a, sizeof(a));
+                    memcpy(out, a, sizeof(a));
+                    savaMixScalar(ref + da, b + sa, c + da, len, w);
+                    savaMix(out + da, b + sa, c + da, len, w);
+                    bad += memcmp(ref, out, sizeof(a)) != 0;
+                }
+            }
+        }
+    }
+    CHECK_EQ(bad, 0);
+}
+
+// Постоянный цвет шаблоном из 12 байт против повторения шаблона побайтово
+static void testPatterns() {
+    alignas(4) uint8_t buf[120], ref[120], pattern[12];
+    srand(2);
+    int bad = 0;
+    for (int round = 0; round < 500; round++) {
+        for (size_t i = 0; i < sizeof(buf); i++) buf[i] = rand();
+        for (size_t i = 0; i < 12; i++) pattern[i] = rand();
+        uint16_t w = rand() % 257;
+        size_t len = rand() % (sizeof(buf) + 1);
+
+        memcpy(ref, buf, sizeof(buf));
+        for (size_t i = 0; i < len; i += 12) savaAddSatScalar(ref + i, pattern, len - i < 12 ? len - i : 12);
+        alignas(4) uint8_t out[120];
+        memcpy(out, buf, sizeof(buf));
+        savaAddSatPattern(out, len, pattern);
+        bad += memcmp(ref, out, sizeof(buf)) != 0;
+
+        memcpy(ref, buf, sizeof(buf));
+        for (size_t i = 0; i < len; i += 12) savaBlendScalar(ref + i, pattern, len - i < 12 ? len - i : 12, w);
+        memcpy(out, buf, sizeof(buf));
+        savaBlendPattern(out, len, pattern, w);
+        bad += memcmp(ref, out, sizeof(buf)) != 0;
+    }
+    CHECK_EQ(bad, 0);
+}
+
+int main() {
+    testWordsExhaustive();
+    testBuffers();
+    testPatterns();
+    return hostTestResult();
+}
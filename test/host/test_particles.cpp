@@ -0,0 +1,131 @@
+// Частицы по времени: путь, появление и время жизни не зависят от частоты шагов update().
+#include "SavaLED_ESP32.h"
+#include "host_test.h"
+
+// Доступ к полям частиц для проверок
+class ProbeParticles : public SavaParticles {
+public:
+    int32_t pos(uint16_t i) const { return _pos[i]; }
+    uint32_t age(uint16_t i) const { return _age[i]; }
+};
+
+static const SavaSegment SEG = {0, 1000, false};
+
+// Шаги по step_us до total_us, последний шаг - остаток
+static void run(SavaParticles& p, uint32_t step_us, uint32_t total_us) {
+    SavaTime t = {0, 0};
+    for (uint32_t done = 0; done < total_us; done += t.dt_us) {
+        t.dt_us = total_us - done < step_us ? total_us - done : step_us;
+        t.now_us += t.dt_us;
+        p.update(t, SEG);
+    }
+}
+
+static int32_t travelled(uint32_t step_us, int32_t vel, uint16_t fade_in_ms, uint32_t total_us) {
+    ProbeParticles p;
+    CHECK(p.begin(1));
+    CHECK_EQ(p.spawn(100 * SAVA_PX, vel, 0xFFFFFF, 0, fade_in_ms), 0);
+    run(p, step_us, total_us);
+    CHECK_EQ(p.count(), 1);
+    return p.count() ? p.pos(0) - 100 * SAVA_PX : 0;
+}
+
+static void testFrameRateIndependence() {
+    // 25 пикселей в секунду за 2 с: 50 пикселей при любом шаге (с точностью округления)
+    const int32_t vel = 25 * SAVA_PX;
+    for (uint32_t step : {1000u, 4000u, 16667u, 33333u, 100000u}) {
+        int32_t d = travelled(step, vel, 0, 2000000);
+        CHECK(d >= 50 * SAVA_PX - 1 && d <= 50 * SAVA_PX + 1);
+        d = travelled(step, -vel, 0, 2000000);
+        CHECK(d <= -50 * SAVA_PX + 1 && d >= -50 * SAVA_PX - 1);
+    }
+    // Медленная частица: дробные смещения за шаг не теряются
+    for (uint32_t step : {1000u, 16667u}) {
+        int32_t d = travelled(step, SAVA_PX / 4, 0, 4000000); // 0.25 пикселя в секунду
+        CHECK(d >= SAVA_PX - 1 && d <= SAVA_PX + 1);
+    }
+}
+
+static void testFadeIn() {
+    // Во время появления частица стоит на месте
+    CHECK_EQ(travelled(16667, 100 * SAVA_PX, 500, 499000), 0);
+    // Шаг, на котором появление закончилось, сдвигает только на остаток после него
+    for (uint32_t step : {10000u, 30000u, 70000u}) {
+        int32_t d = travelled(step, 100 * SAVA_PX, 500, 1000000);
+        CHECK(d >= 50 * SAVA_PX - 1 && d <= 50 * SAVA_PX + 1);
+    }
+}
+
+static void testLife() {
+    for (uint32_t step : {5000u, 20000u, 50000u}) {
+        ProbeParticles p;
+        CHECK(p.begin(4));
+        p.spawn(10 * SAVA_PX, 0, 0xFFFFFF, 300);
+        p.spawn(20 * SAVA_PX, 0, 0xFFFFFF, 0);
+        run(p, step, 250000);
+        CHECK_EQ(p.count(), 2);
+        run(p, step, 100000);
+        CHECK_EQ(p.count(), 1);                 // Первая прожила 300 мс
+        CHECK_EQ(p.pos(0), 20 * SAVA_PX);       // На ее место встала вторая
+    }
+
+    // Без времени жизни частица гибнет, только улетев за отрезок. 4400 с - дольше, чем
+    // помещается в 32 бита микросекунд (~4295 с): возраст упирается в максимум, а не
+    // переполняется, частица с медленной скоростью (1/256 пикселя в секунду) жива
+    ProbeParticles p;
+    CHECK(p.begin(1));
+    p.spawn(500 * SAVA_PX, 1, 0xFFFFFF);
+    for (uint16_t s = 0; s < 4400; s++) run(p, SAVA_MAX_STEP_US, 1000000);
+    CHECK_EQ(p.count(), 1);
+    CHECK_EQ(p.age(0), UINT32_MAX);
+    CHECK(p.pos(0) > 500 * SAVA_PX + 16 * SAVA_PX && p.pos(0) < 500 * SAVA_PX + 17 * SAVA_PX);
+}
+
+// Рост пула сохраняет живые частицы
+static void testReserve() {
+    ProbeParticles p;
+    CHECK(p.begin(2));
+    p.spawn(10 * SAVA_PX, SAVA_PX, 0xFF0000, 1000);
+    p.spawn(20 * SAVA_PX, -SAVA_PX, 0x00FF00);
+    run(p, 10000, 500000);
+    int32_t a = p.pos(0), b = p.pos(1);
+    CHECK(p.reserve(8));
+    CHECK_EQ(p.capacity(), 8);
+    CHECK_EQ(p.count(), 2);
+    CHECK_EQ(p.pos(0), a);
+    CHECK_EQ(p.pos(1), b);
+    CHECK(p.reserve(4));                    // Меньше текущего - без изменений
+    CHECK_EQ(p.capacity(), 8);
+    run(p, 10000, 500000);
+    CHECK_EQ(p.count(), 1);                 // Первая прожила 1000 мс, считая и до роста пула
+    CHECK_EQ(p.pos(0), 20 * SAVA_PX - SAVA_PX);
+}
+
+// Больше комет на лету: новые появляются сразу, не дожидаясь, пока улетят летящие
+static void testCometsGrow() {
+    static const uint32_t palette[] = {0xFF0000, 0x00FF00};
+    SavaCometsEffect comets(2, 4, palette, 2, 0, 10);
+    SavaTime t = {0, 0};
+    auto step = [&](uint16_t frames) {
+        for (uint16_t i = 0; i < frames; i++) {
+            t.now_us += 16667;
+            t.dt_us = 16667;
+            comets.update(t, SEG);
+        }
+    };
+    step(5);
+    CHECK_EQ(comets.count(), 2);            // Кометы появляются ~1.8 с - еще на месте
+    comets.configure(SAVA_MAX_COMETS + 5, 4, palette, 2, 0, 10);
+    step(SAVA_MAX_COMETS + 5);
+    CHECK_EQ(comets.count(), SAVA_MAX_COMETS + 5);
+    CHECK_EQ(comets.capacity(), SAVA_MAX_COMETS + 5);
+}
+
+int main() {
+    testFrameRateIndependence();
+    testFadeIn();
+    testLife();
+    testReserve();
+    testCometsGrow();
+    return hostTestResult();
+}
@@ -0,0 +1,93 @@
+// Пропуск неизменных кадров и повтор раз в keepalive_ms (setSkipUnchanged) во всех режимах
+// буферов: повтор должен передать тот же кадр, что ушел последним. Гистограммы времени кадра.
+#include <vector>
+#include "SavaLED_ESP32.h"
+#include "host_test.h"
+
+static void drawFrame(SavaLED_ESP32& strip, uint32_t color) {
+    strip.fill(color);
+    strip.setPixel(1, 0x0000FF);
+}
+
+// Последний переданный кадр: байты (энкодер байтов) или символы (коррекция в энкодере)
+static std::vector<uint32_t> lastFrame(bool encoder) {
+    if (encoder) return host_tx_symbols;
+    return std::vector<uint32_t>(host_tx_bytes.begin(), host_tx_bytes.end());
+}
+
+static void testKeepalive(bool double_buffer, bool encoder, uint8_t pipeline, bool dither) {
+    SavaLEDConfig config;
+    config.pipeline_depth = pipeline;
+    SavaLED_ESP32 strip;
+    strip.setDoubleBuffer(double_buffer);
+    strip.setEncoderCorrection(encoder);
+    strip.setSkipUnchanged(true, 100);
+    if (dither) CHECK(strip.setDithering(true));
+    CHECK(strip.begin(8, 5, config));
+    strip.setBrightness(128);
+
+    drawFrame(strip, 0x203040);
+    strip.show();
+    host_advance_time(1000);
+    drawFrame(strip, 0x405060);
+    strip.show();
+    const std::vector<uint32_t> sent = lastFrame(encoder);
+    const int count = host_tx_count;
+
+    // Без рисования: в пределах keepalive_ms кадр не передается
+    host_advance_time(50000);
+    strip.show();
+    CHECK_EQ(host_tx_count, count);
+
+    // Повтор - тот же кадр, а не старое содержимое буфера рисования
+    host_advance_time(60000);
+    strip.show();
+    CHECK_EQ(host_tx_count, count + 1);
+    if (!dither) CHECK(lastFrame(encoder) == sent);
+
+    // Новый кадр после повтора передается как обычно
+    drawFrame(strip, 0x405060);
+    strip.show();
+    CHECK_EQ(host_tx_count, count + 2);
+    if (!dither) CHECK(lastFrame(encoder) == sent);
+}
+
+// Гистограммы этапов: каждый кадр попадает в корзину своего времени
+static void testHistogram() {
+    SavaLED_ESP32 strip;
+    CHECK(strip.begin(8, 5));
+    strip.show();
+    for (uint8_t k = 0; k < 5; k++) {
+        host_advance_time(3000);            // Отрисовка 3 мс: корзина 2^11..2^12 мкс
+        strip.show();
+    }
+    host_advance_time(40000);               // Длинный кадр - в последней корзине
+    strip.show();
+
+    SavaTimingHistogram render = strip.getTimingHistogram(SAVA_STAGE_RENDER);
+    CHECK_EQ(render.bins[11], 5);
+    CHECK_EQ(render.bins[SAVA_STATS_BINS - 1], 1);
+    uint32_t total = 0;
+    for (uint8_t k = 0; k < SAVA_STATS_BINS; k++) total += render.bins[k];
+    CHECK_EQ(total, 6);                     // Первый кадр отрисовки не имеет начала
+
+    // Заглушка RMT завершает передачу сразу в show()
+    SavaTimingHistogram wire = strip.getTimingHistogram(SAVA_STAGE_WIRE);
+    CHECK_EQ(wire.bins[0], 7);
+
+    strip.resetStats();
+    CHECK_EQ(strip.getTimingHistogram(SAVA_STAGE_PREP).bins[0], 0);
+    CHECK_EQ(strip.getTimingHistogram(SAVA_STAGE_WIRE).bins[0], 0);
+}
+
+int main() {
+    testKeepalive(false, false, 1, false);  // Копирование
+    testKeepalive(false, false, 3, false);
+    testKeepalive(true, false, 1, false);   // Двойной буфер
+    testKeepalive(true, false, 2, false);
+    testKeepalive(true, false, 2, true);
+    testKeepalive(false, true, 1, false);   // Коррекция в энкодере прямо из буфера рисования
+    testKeepalive(false, true, 3, false);   // ... и с конвейером (обмен буферов)
+    testHistogram();
+    return hostTestResult();
+}
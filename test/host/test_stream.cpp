@@ -0,0 +1,280 @@
+// Прием потока (SavaStreamReceiver): пакеты E1.31, Art-Net и DDP собираются по спецификациям
+// и подаются в handlePacket(), проверяется буфер ленты (порядок GRB), счетчики и показ кадра.
+#include <vector>
+#include <cstring>
+#include "SavaLED_Stream.h"
+#include "lwip/sockets.h"
+#include "host_test.h"
+
+typedef std::vector<uint8_t> Packet;
+
+static void put16(Packet& p, size_t at, uint16_t v) {
+    p[at] = v >> 8;
+    p[at + 1] = v & 0xFF;
+}
+
+static void put32(Packet& p, size_t at, uint32_t v) {
+    put16(p, at, v >> 16);
+    put16(p, at + 2, v & 0xFFFF);
+}
+
+// E1.31 с данными: 126 байт заголовков, затем каналы
+static Packet e131(uint16_t universe, uint8_t seq, const Packet& channels, uint16_t sync = 0) {
+    Packet p(126 + channels.size());
+    static const char acn[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+    put16(p, 0, 0x0010);
+    memcpy(&p[4], acn, sizeof(acn));
+    put32(p, 18, 0x00000004);               // Корневой вектор: данные
+    put32(p, 40, 0x00000002);               // Кадрирование: DMP
+    put16(p, 109, sync);
+    p[111] = seq;
+    put16(p, 113, universe);
+    p[117] = 0x02;
+    p[118] = 0xA1;
+    put16(p, 123, channels.size() + 1);     // Вместе со стартовым кодом
+    memcpy(&p[126], channels.data(), channels.size());
+    return p;
+}
+
+static Packet e131Sync(uint16_t address) {
+    Packet p(49);
+    static const char acn[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+    memcpy(&p[4], acn, sizeof(acn));
+    put32(p, 18, 0x00000008);
+    put32(p, 40, 0x00000001);
+    put16(p, 45, address);
+    return p;
+}
+
+static Packet artDmx(uint16_t universe, uint8_t seq, const Packet& channels) {
+    Packet p(18 + channels.size());
+    memcpy(&p[0], "Art-Net", 8);
+    p[8] = 0x00;                            // OpDmx 0x5000, младший байт первым
+    p[9] = 0x50;
+    p[11] = 14;
+    p[12] = seq;
+    p[14] = universe & 0xFF;
+    p[15] = universe >> 8;
+    put16(p, 16, channels.size());
+    memcpy(&p[18], channels.data(), channels.size());
+    return p;
+}
+
+static Packet artSync() {
+    Packet p(14);
+    memcpy(&p[0], "Art-Net", 8);
+    p[9] = 0x52;
+    p[11] = 14;
+    return p;
+}
+
+static Packet ddp(uint32_t offset, const Packet& channels, bool push, uint8_t seq = 0) {
+    Packet p(10 + channels.size());
+    p[0] = 0x40 | (push ? 0x01 : 0);
+    p[1] = seq;
+    p[2] = 0x0B;                            // RGB, 8 бит
+    p[3] = 1;
+    put32(p, 4, offset);
+    put16(p, 8, channels.size());
+    memcpy(&p[10], channels.data(), channels.size());
+    return p;
+}
+
+static bool feed(SavaStreamReceiver& rx, SavaStreamProtocol protocol, const Packet& p, size_t len = SIZE_MAX) {
+    return rx.handlePacket(protocol, p.data(), len < p.size() ? len : p.size());
+}
+
+// Пиксель ленты в порядке R, G, B (буфер хранит GRB)
+static uint32_t rgb(SavaLED_ESP32& strip, uint16_t i) {
+    const uint8_t* px = strip.getPixels() + i * 3;
+    return ((uint32_t)px[1] << 16) | ((uint32_t)px[0] << 8) | px[2];
+}
+
+// Разбор без сокетов: protocols = 0, begin() только настраивает прием
+static SavaStreamConfig parserConfig() {
+    SavaStreamConfig cfg;
+    cfg.protocols = 0;
+    return cfg;
+}
+
+static void testE131() {
+    SavaLED_ESP32 strip;
+    CHECK(strip.begin(10, 5));
+    SavaStreamReceiver rx(strip);
+    rx.begin(parserConfig());
+
+    int shown = host_tx_count;
+    CHECK(feed(rx, SAVA_STREAM_E131, e131(1, 1, {0x11, 0x22, 0x33, 0x44, 0x55, 0x66})));
+    CHECK_EQ(rgb(strip, 0), 0x112233);
+    CHECK_EQ(rgb(strip, 1), 0x445566);
+    CHECK_EQ(rgb(strip, 2), 0);
+    CHECK_EQ(rx.getStats().frames, 1);       // Одна вселенная покрывает ленту - кадр собран
+    CHECK_EQ(host_tx_count, shown + 1);
+
+    // Повтор номера последовательности отбрасывается, буфер не меняется
+    CHECK(feed(rx, SAVA_STREAM_E131, e131(1, 1, {0xFF, 0xFF, 0xFF})));
+    CHECK_EQ(rx.getStats().out_of_order, 1);
+    CHECK_EQ(rgb(strip, 0), 0x112233);
+
+    // Вселенные вне ленты: 0 (в E1.31 нумерация с 1) и 2
+    CHECK(!feed(rx, SAVA_STREAM_E131, e131(0, 2, {0xAA, 0xAA, 0xAA})));
+    CHECK(!feed(rx, SAVA_STREAM_E131, e131(2, 3, {0xAA, 0xAA, 0xAA})));
+    CHECK_EQ(rx.getStats().invalid, 2);
+
+    // Обрезанные пакеты: меньше заголовка и меньше заявленного кол-ва каналов
+    Packet p = e131(1, 4, {0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA});
+    CHECK(!feed(rx, SAVA_STREAM_E131, p, 120));
+    CHECK(!feed(rx, SAVA_STREAM_E131, p, p.size() - 1));
+    CHECK_EQ(rx.getStats().invalid, 4);
+    CHECK_EQ(rgb(strip, 0), 0x112233);
+    CHECK_EQ(rx.getStats().packets, 1);
+}
+
+// Две вселенные на кадр: показ по последней, а с адресом синхронизации - только по пакету sync
+static void testE131Frames() {
+    SavaLED_ESP32 strip;
+    CHECK(strip.begin(200, 5));             // 600 каналов - две вселенные по 510
+    SavaStreamReceiver rx(strip);
+    rx.begin(parserConfig());
+
+    Packet second(90, 0x07);
+    CHECK(feed(rx, SAVA_STREAM_E131, e131(2, 1, second)));
+    CHECK_EQ(rx.getStats().frames, 0);
+    CHECK(feed(rx, SAVA_STREAM_E131, e131(1, 1, Packet(510, 0x01))));
+    CHECK_EQ(rx.getStats().frames, 1);
+    CHECK_EQ(rgb(strip, 169), 0x010101);
+    CHECK_EQ(rgb(strip, 170), 0x070707);    // Вселенная 2 начинается со 171-го светодиода
+    CHECK_EQ(rgb(strip, 199), 0x070707);
+
+    CHECK(feed(rx, SAVA_STREAM_E131, e131(1, 2, Packet(510, 0x02), 7000)));
+    CHECK(feed(rx, SAVA_STREAM_E131, e131(2, 2, second, 7000)));
+    CHECK_EQ(rx.getStats().frames, 1);
+    CHECK(feed(rx, SAVA_STREAM_E131, e131Sync(7001)));     // Чужой адрес
+    CHECK_EQ(rx.getStats().frames, 1);
+    CHECK(feed(rx, SAVA_STREAM_E131, e131Sync(7000)));
+    CHECK_EQ(rx.getStats().frames, 2);
+    CHECK_EQ(rgb(strip, 0), 0x020202);
+}
+
+static void testArtNet() {
+    SavaLED_ESP32 strip;
+    CHECK(strip.begin(10, 5));
+    SavaStreamReceiver rx(strip);
+    rx.begin(parserConfig());
+
+    // Art-Net нумерует вселенные с 0: по умолчанию лента начинается с вселенной 0
+    CHECK(feed(rx, SAVA_STREAM_ARTNET, artDmx(0, 1, {0x10, 0x20, 0x30})));
+    CHECK_EQ(rgb(strip, 0), 0x102030);
+    CHECK_EQ(rx.getStats().frames, 1);
+    CHECK(!feed(rx, SAVA_STREAM_ARTNET, artDmx(1, 2, {0xAA, 0xAA, 0xAA})));
+    CHECK(!feed(rx, SAVA_STREAM_ARTNET, artDmx(0x100, 3, {0xAA, 0xAA, 0xAA})));
+    CHECK_EQ(rx.getStats().invalid, 2);
+
+    // Обрезанный пакет и чужой заголовок
+    Packet p = artDmx(0, 4, {0xAA, 0xAA, 0xAA});
+    CHECK(!feed(rx, SAVA_STREAM_ARTNET, p, 17));
+    CHECK(!feed(rx, SAVA_STREAM_ARTNET, p, p.size() - 1));
+    p[0] = 'X';
+    CHECK(!feed(rx, SAVA_STREAM_ARTNET, p));
+    CHECK_EQ(rx.getStats().invalid, 5);
+    CHECK_EQ(rgb(strip, 0), 0x102030);
+
+    // Номер 0 - последовательность не используется, повтор не отбрасывается
+    CHECK(feed(rx, SAVA_STREAM_ARTNET, artDmx(0, 0, {0x01, 0x02, 0x03})));
+    CHECK(feed(rx, SAVA_STREAM_ARTNET, artDmx(0, 0, {0x04, 0x05, 0x06})));
+    CHECK_EQ(rgb(strip, 0), 0x040506);
+    CHECK_EQ(rx.getStats().out_of_order, 0);
+
+    // Источник с ArtSync: кадр показывается только по синхронизации
+    uint32_t frames = rx.getStats().frames;
+    CHECK(feed(rx, SAVA_STREAM_ARTNET, artSync()));
+    CHECK(feed(rx, SAVA_STREAM_ARTNET, artDmx(0, 5, {0x0A, 0x0B, 0x0C})));
+    CHECK_EQ(rx.getStats().frames, frames + 1);
+    CHECK(feed(rx, SAVA_STREAM_ARTNET, artSync()));
+    CHECK_EQ(rx.getStats().frames, frames + 2);
+    CHECK_EQ(rgb(strip, 0), 0x0A0B0C);
+
+    // Настроенная база: вселенные ниже нее - вне ленты
+    SavaStreamConfig cfg = parserConfig();
+    cfg.artnet_start_universe = 3;
+    rx.begin(cfg);
+    CHECK(!feed(rx, SAVA_STREAM_ARTNET, artDmx(2, 6, {0xAA, 0xAA, 0xAA})));
+    CHECK(feed(rx, SAVA_STREAM_ARTNET, artDmx(3, 6, {0x21, 0x22, 0x23})));
+    CHECK_EQ(rgb(strip, 0), 0x212223);
+}
+
+static void testDDP() {
+    SavaLED_ESP32 strip;
+    CHECK(strip.begin(10, 5));
+    SavaStreamReceiver rx(strip);
+    rx.begin(parserConfig());
+
+    // Пакет начинается посреди пикселя: смещение 4 - канал G второго светодиода
+    CHECK(feed(rx, SAVA_STREAM_DDP, ddp(4, {0x22, 0x33, 0x44, 0x55, 0x66}, false, 1)));
+    CHECK_EQ(rx.getStats().frames, 0);
+    CHECK(feed(rx, SAVA_STREAM_DDP, ddp(0, {0x10, 0x20, 0x30, 0x11}, true, 2)));
+    CHECK_EQ(rx.getStats().frames, 1);
+    CHECK_EQ(rgb(strip, 0), 0x102030);
+    CHECK_EQ(rgb(strip, 1), 0x112233);
+    CHECK_EQ(rgb(strip, 2), 0x445566);
+
+    // Опоздавший пакет (номер 1 после 2) отбрасывается
+    CHECK(feed(rx, SAVA_STREAM_DDP, ddp(0, {0xFF, 0xFF, 0xFF}, true, 1)));
+    CHECK_EQ(rx.getStats().out_of_order, 1);
+    CHECK_EQ(rgb(strip, 0), 0x102030);
+
+    // Данные за концом ленты обрезаются, вне ленты - пропускаются
+    CHECK(feed(rx, SAVA_STREAM_DDP, ddp(27, {0x71, 0x72, 0x73, 0x74, 0x75, 0x76}, false)));
+    CHECK_EQ(rgb(strip, 9), 0x717273);
+    CHECK(feed(rx, SAVA_STREAM_DDP, ddp(300, {0xAA, 0xAA, 0xAA}, false)));
+
+    // Обрезанные пакеты и чужая версия
+    Packet p = ddp(0, {0xAA, 0xAA, 0xAA}, true);
+    CHECK(!feed(rx, SAVA_STREAM_DDP, p, 9));
+    CHECK(!feed(rx, SAVA_STREAM_DDP, p, p.size() - 1));
+    p[0] = 0x81;
+    CHECK(!feed(rx, SAVA_STREAM_DDP, p));
+    CHECK_EQ(rx.getStats().invalid, 3);
+    CHECK_EQ(rgb(strip, 0), 0x102030);
+}
+
+// Через сокет: пакет DDP на 127.0.0.1 принимается poll(). Порт занят - проверка пропускается
+static void testLoopback() {
+    SavaLED_ESP32 strip;
+    CHECK(strip.begin(10, 5));
+    SavaStreamReceiver rx(strip);
+    SavaStreamConfig cfg;
+    cfg.protocols = SAVA_STREAM_DDP;
+    if (!rx.begin(cfg)) {
+        printf("loopback: port %d unavailable, skipped\n", SAVA_DDP_PORT);
+        return;
+    }
+    int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    CHECK(s >= 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(SAVA_DDP_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    Packet p = ddp(3, {0x31, 0x32, 0x33}, true);
+    CHECK_EQ(sendto(s, p.data(), p.size(), 0, (struct sockaddr*)&addr, sizeof(addr)), (long long)p.size());
+    close(s);
+
+    uint16_t handled = 0;
+    for (int i = 0; i < 100 && !handled; i++) {
+        handled = rx.poll();
+        if (!handled) usleep(1000);
+    }
+    CHECK_EQ(handled, 1);
+    CHECK(rx.frameReady());
+    CHECK_EQ(rgb(strip, 1), 0x313233);
+    rx.end();
+}
+
+int main() {
+    testE131();
+    testE131Frames();
+    testArtNet();
+    testDDP();
+    testLoopback();
+    return hostTestResult();
+}